@@ -0,0 +1,156 @@
+// Microbenchmark of the ECS ComponentContainer against the previous hash map based container.
+// Only depends on tiny_ecs, build with -DBLENDY_BUILD_BENCHMARKS=ON or directly with
+//   g++ -std=c++14 -O2 -Isrc bench/ecs_bench.cpp src/tiny_ecs.cpp -o ecs_bench
+
+// stlib
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <unordered_map>
+
+// internal
+#include "tiny_ecs.hpp"
+
+using Clock = std::chrono::high_resolution_clock;
+
+// Same footprint as the game's Motion component, without pulling in glm
+struct BenchMotion {
+	float position[2] = { 0, 0 };
+	float angle = 0;
+	float velocity[2] = { 0, 0 };
+	float scale[2] = { 10, 10 };
+	int type = 0;
+};
+
+// The ComponentContainer as it was before the sparse set, kept here as the baseline
+template <typename Component>
+class HashMapComponentContainer
+{
+	std::unordered_map<unsigned int, unsigned int> map_entity_componentID;
+public:
+	std::vector<Component> components;
+	std::vector<Entity> entities;
+
+	Component& insert(Entity e, Component c)
+	{
+		map_entity_componentID[e] = (unsigned int)components.size();
+		components.push_back(std::move(c));
+		entities.push_back(e);
+		return components.back();
+	}
+
+	Component& get(Entity e) {
+		return components[map_entity_componentID[e]];
+	}
+
+	bool has(Entity entity) {
+		return map_entity_componentID.count(entity) > 0;
+	}
+
+	void remove(Entity e)
+	{
+		if (has(e))
+		{
+			int cID = map_entity_componentID[e];
+			components[cID] = std::move(components.back());
+			entities[cID] = entities.back();
+			map_entity_componentID[entities.back()] = cID;
+			map_entity_componentID.erase(e);
+			components.pop_back();
+			entities.pop_back();
+		}
+	}
+
+	template <class Compare>
+	void sort(Compare comparisonFunction)
+	{
+		std::sort(entities.begin(), entities.end(), comparisonFunction);
+		std::vector<Component> components_new; components_new.reserve(components.size());
+		std::transform(entities.begin(), entities.end(), std::back_inserter(components_new), [&](Entity e) { return std::move(get(e)); });
+		components = std::move(components_new);
+		for (unsigned int i = 0; i < entities.size(); i++)
+			map_entity_componentID[entities[i]] = i;
+	}
+};
+
+// Runs fn and returns the elapsed time in nanoseconds per operation
+template <typename Fn>
+double time_per_op(size_t ops, Fn fn)
+{
+	auto t = Clock::now();
+	fn();
+	auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t).count();
+	return (double)elapsed / (double)ops;
+}
+
+struct BenchResult {
+	double insert, get, has, remove, sort;
+};
+
+template <typename Container>
+BenchResult run(const std::vector<Entity>& entities, const std::vector<Entity>& lookup_order, const std::vector<Entity>& probes)
+{
+	BenchResult result;
+	Container container;
+	volatile float sink = 0;
+	size_t n = entities.size();
+
+	result.insert = time_per_op(n, [&]() {
+		for (Entity e : entities)
+			container.insert(e, BenchMotion());
+	});
+	result.get = time_per_op(n, [&]() {
+		float sum = 0;
+		for (Entity e : lookup_order)
+			sum += container.get(e).position[0];
+		sink = sum;
+	});
+	result.has = time_per_op(probes.size(), [&]() {
+		unsigned int hits = 0;
+		for (Entity e : probes)
+			hits += container.has(e) ? 1 : 0;
+		sink = (float)hits;
+	});
+	result.sort = time_per_op(n, [&]() {
+		container.sort([](Entity a, Entity b) { return (unsigned int)b < (unsigned int)a; });
+	});
+	result.remove = time_per_op(n, [&]() {
+		for (Entity e : lookup_order)
+			container.remove(e);
+	});
+	(void)sink;
+	return result;
+}
+
+int main()
+{
+	std::default_random_engine rng(42);
+	const size_t sizes[] = { 80, 1000, 10000, 100000 };
+	const int repetitions = 5;
+
+	printf("%8s %-10s %10s %10s %10s %10s %10s   (ns/op)\n", "n", "container", "insert", "get", "has", "remove", "sort");
+	for (size_t n : sizes)
+	{
+		// Entities not in the container are used as misses for has()
+		std::vector<Entity> entities(n), unused(n);
+		std::vector<Entity> lookup_order = entities;
+		std::shuffle(lookup_order.begin(), lookup_order.end(), rng);
+		std::vector<Entity> probes = lookup_order;
+		probes.insert(probes.end(), unused.begin(), unused.end());
+		std::shuffle(probes.begin(), probes.end(), rng);
+
+		BenchResult best_sparse = { 1e30, 1e30, 1e30, 1e30, 1e30 };
+		BenchResult best_hash = best_sparse;
+		for (int r = 0; r < repetitions; r++)
+		{
+			BenchResult sparse = run<ComponentContainer<BenchMotion>>(entities, lookup_order, probes);
+			BenchResult hash = run<HashMapComponentContainer<BenchMotion>>(entities, lookup_order, probes);
+			best_sparse = { std::min(best_sparse.insert, sparse.insert), std::min(best_sparse.get, sparse.get), std::min(best_sparse.has, sparse.has), std::min(best_sparse.remove, sparse.remove), std::min(best_sparse.sort, sparse.sort) };
+			best_hash = { std::min(best_hash.insert, hash.insert), std::min(best_hash.get, hash.get), std::min(best_hash.has, hash.has), std::min(best_hash.remove, hash.remove), std::min(best_hash.sort, hash.sort) };
+		}
+		printf("%8zu %-10s %10.2f %10.2f %10.2f %10.2f %10.2f\n", n, "sparse", best_sparse.insert, best_sparse.get, best_sparse.has, best_sparse.remove, best_sparse.sort);
+		printf("%8zu %-10s %10.2f %10.2f %10.2f %10.2f %10.2f\n", n, "hash map", best_hash.insert, best_hash.get, best_hash.has, best_hash.remove, best_hash.sort);
+	}
+	return EXIT_SUCCESS;
+}
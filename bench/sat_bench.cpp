@@ -0,0 +1,179 @@
+// Microbenchmark of the SAT kernel against the previous std::vector based narrowphase functions.
+// Only depends on glm and src/sat.cpp, build with -DBLENDY_BUILD_BENCHMARKS=ON or directly with
+//   g++ -std=c++14 -O2 -Isrc -Iext/glm bench/sat_bench.cpp src/sat.cpp -o sat_bench
+
+// stlib
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <glm/geometric.hpp>
+
+// internal
+#include "sat.hpp"
+
+using Clock = std::chrono::high_resolution_clock;
+using glm::vec2;
+
+// The narrowphase as it was before the precomputed hull, kept here as the baseline. It tests every
+// triangle of the mesh against the rectangle and allocates several vectors per triangle.
+namespace baseline
+{
+	vec2 normalize(const vec2& v)
+	{
+		float length = std::sqrt(v.x * v.x + v.y * v.y);
+		return { v.x / length, v.y / length };
+	}
+
+	bool isParallel(const std::vector<vec2>& axis, const vec2& edge)
+	{
+		for (const auto& existing_axis : axis) {
+			float crossProduct = edge.x * existing_axis.y - edge.y * existing_axis.x;
+			if (std::abs(crossProduct) < 0.0000001)
+				return true;
+		}
+		return false;
+	}
+
+	std::vector<vec2> getRectangleEdge(vec2 position, vec2 scale, std::vector<vec2>& shape)
+	{
+		std::vector<vec2> rectangle(4);
+		float halfWidth = std::abs(scale.x) / 2.0f;
+		float halfHeight = std::abs(scale.y) / 2.0f;
+		vec2 topLeft = { position.x - halfWidth, position.y + halfHeight };
+		vec2 topRight = { position.x + halfWidth, position.y + halfHeight };
+		vec2 bottomLeft = { position.x - halfWidth, position.y - halfHeight };
+		vec2 bottomRight = { position.x + halfWidth, position.y - halfHeight };
+		shape.push_back(topLeft);
+		shape.push_back(topRight);
+		shape.push_back(bottomLeft);
+		shape.push_back(bottomRight);
+		rectangle[0] = normalize(topRight - topLeft);
+		rectangle[1] = normalize(bottomRight - topRight);
+		rectangle[2] = normalize(bottomLeft - bottomRight);
+		rectangle[3] = normalize(topLeft - bottomLeft);
+		return rectangle;
+	}
+
+	std::pair<float, float> projectOntoAxis(const std::vector<vec2>& shape, const vec2& axis)
+	{
+		float minProj = glm::dot(shape[0], axis);
+		float maxProj = minProj;
+		for (const auto& point : shape) {
+			float proj = glm::dot(point, axis);
+			minProj = std::min(minProj, proj);
+			maxProj = std::max(maxProj, proj);
+		}
+		return { minProj, maxProj };
+	}
+
+	bool projectionsOverlap(const std::pair<float, float>& proj1, const std::pair<float, float>& proj2)
+	{
+		return !(proj1.second < proj2.first || proj2.second < proj1.first);
+	}
+
+	// Triangles in world space, three vertices each
+	bool checkMeshCollisionSAT(const std::vector<vec2>& triangles, vec2 position, vec2 scale)
+	{
+		std::vector<vec2> axises;
+		std::vector<vec2> edges;
+		std::vector<vec2> rectangle_shape;
+		std::vector<vec2> rectangle = getRectangleEdge(position, scale, rectangle_shape);
+		std::vector<vec2> shape;
+		bool collision = false;
+		for (size_t i = 0; i + 2 < triangles.size(); i += 3) {
+			axises = rectangle;
+			edges.clear();
+			shape.clear();
+			shape.push_back(triangles[i]);
+			shape.push_back(triangles[i + 1]);
+			shape.push_back(triangles[i + 2]);
+			edges.push_back(triangles[i + 1] - triangles[i]);
+			edges.push_back(triangles[i + 2] - triangles[i + 1]);
+			edges.push_back(triangles[i] - triangles[i + 2]);
+			for (const auto& edge : edges)
+				if (!isParallel(axises, edge))
+					axises.push_back(normalize(edge));
+			for (const vec2 axis : axises) {
+				if (projectionsOverlap(projectOntoAxis(shape, axis), projectOntoAxis(rectangle_shape, axis)))
+					collision = true;
+			}
+		}
+		return collision;
+	}
+}
+
+// Runs fn and returns the elapsed time in nanoseconds per operation
+template <typename Fn>
+double time_per_op(size_t ops, Fn fn)
+{
+	auto t = Clock::now();
+	fn();
+	auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t).count();
+	return (double)elapsed / (double)ops;
+}
+
+int main()
+{
+	std::default_random_engine rng(42);
+	std::uniform_real_distribution<float> offset(-60.f, 60.f);
+	const int sizes[] = { 4, 8, 16, 32, 62 };
+	const size_t tests = 100000;
+	const int repetitions = 5;
+
+	printf("%8s %12s %12s %12s   (ns/test)\n", "vertices", "baseline", "scalar", "simd");
+	for (int n : sizes)
+	{
+		// A regular polygon of radius 50 at the origin, as a fan of triangles for the baseline
+		ConvexPolygon polygon;
+		std::vector<vec2> triangles;
+		for (int i = 0; i < n; i++)
+		{
+			const float t0 = (float)i * 6.2831853f / (float)n;
+			const float t1 = (float)(i + 1) * 6.2831853f / (float)n;
+			polygon.add({ 50.f * std::cos(t0), 50.f * std::sin(t0) });
+			triangles.push_back({ 0.f, 0.f });
+			triangles.push_back({ 50.f * std::cos(t0), 50.f * std::sin(t0) });
+			triangles.push_back({ 50.f * std::cos(t1), 50.f * std::sin(t1) });
+		}
+
+		// Boxes around the polygon, about half of them overlap it
+		const vec2 box_scale = { 20.f, 30.f };
+		std::vector<vec2> positions(tests);
+		std::vector<ConvexPolygon> boxes(tests);
+		for (size_t i = 0; i < tests; i++)
+		{
+			positions[i] = { offset(rng), offset(rng) };
+			boxes[i] = ConvexPolygon::box(positions[i] - box_scale / 2.f, positions[i] + box_scale / 2.f);
+		}
+
+		double best_baseline = 1e30, best_scalar = 1e30, best_simd = 1e30;
+		size_t hits[3] = { 0, 0, 0 };
+		for (int r = 0; r < repetitions; r++)
+		{
+			best_baseline = std::min(best_baseline, time_per_op(tests, [&]() {
+				hits[0] = 0;
+				for (size_t i = 0; i < tests; i++)
+					hits[0] += baseline::checkMeshCollisionSAT(triangles, positions[i], box_scale) ? 1 : 0;
+			}));
+			best_scalar = std::min(best_scalar, time_per_op(tests, [&]() {
+				hits[1] = 0;
+				for (size_t i = 0; i < tests; i++)
+					hits[1] += polygons_overlap_scalar(polygon, boxes[i]) ? 1 : 0;
+			}));
+			best_simd = std::min(best_simd, time_per_op(tests, [&]() {
+				hits[2] = 0;
+				for (size_t i = 0; i < tests; i++)
+					hits[2] += polygons_overlap(polygon, boxes[i]) ? 1 : 0;
+			}));
+		}
+		// The baseline reports any triangle whose projections overlap on one axis, so its hit count
+		// is an upper bound of the exact test
+		printf("%8d %12.2f %12.2f %12.2f   hits %zu / %zu / %zu\n", n, best_baseline, best_scalar, best_simd, hits[0], hits[1], hits[2]);
+	}
+	return EXIT_SUCCESS;
+}
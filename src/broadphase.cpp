@@ -0,0 +1,638 @@
+// internal
+#include "broadphase.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+const char* broadphase_name(BroadphaseMode mode)
+{
+	switch (mode)
+	{
+	case BroadphaseMode::BRUTE_FORCE: return "brute force";
+	case BroadphaseMode::UNIFORM_GRID: return "uniform grid";
+	case BroadphaseMode::SWEEP_AND_PRUNE: return "sweep and prune";
+	case BroadphaseMode::AABB_TREE: return "AABB tree";
+	default: return "unknown";
+	}
+}
+
+UniformGrid::UniformGrid(float width, float height, float cell_size)
+	: cell_size(cell_size)
+{
+	columns = std::max(1, (int)std::ceil(width / cell_size));
+	rows = std::max(1, (int)std::ceil(height / cell_size));
+	cell_start.resize(columns * rows + 1);
+}
+
+int UniformGrid::cell_x(float x) const
+{
+	return std::min(std::max((int)std::floor(x / cell_size), 0), columns - 1);
+}
+
+int UniformGrid::cell_y(float y) const
+{
+	return std::min(std::max((int)std::floor(y / cell_size), 0), rows - 1);
+}
+
+bool UniformGrid::is_oversized(const Box& box) const
+{
+	return (box.x1 - box.x0 + 1) * (box.y1 - box.y0 + 1) > MAX_CELLS;
+}
+
+void UniformGrid::clear()
+{
+	boxes.clear();
+}
+
+void UniformGrid::insert(unsigned int proxy, vec2 min, vec2 max)
+{
+	boxes.push_back({ proxy, cell_x(min.x), cell_y(min.y), cell_x(max.x), cell_y(max.y) });
+}
+
+void UniformGrid::find_pairs(std::vector<ProxyPair>& pairs)
+{
+	// Counting sort of the boxes into their cells, first count the entries per cell ...
+	oversized.clear();
+	std::fill(cell_start.begin(), cell_start.end(), 0);
+	for (unsigned int i = 0; i < boxes.size(); i++)
+	{
+		const Box& box = boxes[i];
+		if (is_oversized(box))
+		{
+			oversized.push_back(i);
+			continue;
+		}
+		for (int y = box.y0; y <= box.y1; y++)
+			for (int x = box.x0; x <= box.x1; x++)
+				cell_start[y * columns + x + 1]++;
+	}
+
+	// ... then turn the counts into offsets and fill the entries
+	for (size_t c = 1; c < cell_start.size(); c++)
+		cell_start[c] += cell_start[c - 1];
+	cell_entries.resize(cell_start.back());
+	for (unsigned int i = 0; i < boxes.size(); i++)
+	{
+		const Box& box = boxes[i];
+		if (is_oversized(box))
+			continue;
+		for (int y = box.y0; y <= box.y1; y++)
+			for (int x = box.x0; x <= box.x1; x++)
+				cell_entries[cell_start[y * columns + x]++] = i;
+	}
+	// The fill advanced every start to the start of the next cell, shift them back
+	for (size_t c = cell_start.size() - 1; c > 0; c--)
+		cell_start[c] = cell_start[c - 1];
+	cell_start[0] = 0;
+
+	auto add_pair = [&pairs](unsigned int a, unsigned int b) {
+		pairs.push_back(a < b ? ProxyPair(a, b) : ProxyPair(b, a));
+	};
+
+	// Two boxes can share several cells, the pair is only reported in the cell that holds the
+	// lower left corner of their overlap
+	for (int y = 0; y < rows; y++)
+		for (int x = 0; x < columns; x++)
+		{
+			const unsigned int first = cell_start[y * columns + x], last = cell_start[y * columns + x + 1];
+			for (unsigned int i = first; i < last; i++)
+				for (unsigned int j = i + 1; j < last; j++)
+				{
+					const Box& a = boxes[cell_entries[i]];
+					const Box& b = boxes[cell_entries[j]];
+					if (std::max(a.x0, b.x0) == x && std::max(a.y0, b.y0) == y)
+						add_pair(a.proxy, b.proxy);
+				}
+		}
+
+	// The oversized boxes are paired with all others, pairs of two oversized boxes only once
+	for (unsigned int i : oversized)
+		for (unsigned int j = 0; j < boxes.size(); j++)
+			if (!is_oversized(boxes[j]) || j > i)
+				add_pair(boxes[i].proxy, boxes[j].proxy);
+}
+
+static uint64_t pair_key(unsigned int a, unsigned int b)
+{
+	return a < b ? (uint64_t)a << 32 | b : (uint64_t)b << 32 | a;
+}
+
+void SweepAndPrune::set_box(Entity entity, unsigned int index, vec2 min, vec2 max)
+{
+	unsigned int& slot = lookup.assure(entity);
+	if (slot != SPARSE_INVALID_INDEX && proxies[slot].used && proxies[slot].entity == entity)
+	{
+		Proxy& proxy = proxies[slot];
+		proxy.index = index;
+		proxy.min = min;
+		proxy.max = max;
+		proxy.stamp = stamp;
+		return;
+	}
+
+	// A new proxy, one of an older entity with the same index is left to remove_stale_proxies()
+	unsigned int id;
+	if (!free_proxies.empty())
+	{
+		id = free_proxies.back();
+		free_proxies.pop_back();
+		proxies[id] = { entity, index, min, max, stamp, true };
+	}
+	else
+	{
+		id = (unsigned int)proxies.size();
+		proxies.push_back({ entity, index, min, max, stamp, true });
+	}
+	slot = id;
+
+	// Appended at the end, the next sort moves the endpoints into place and reports the overlaps
+	for (int axis = 0; axis < 2; axis++)
+	{
+		axes[axis].push_back({ min[axis], id, false });
+		axes[axis].push_back({ max[axis], id, true });
+	}
+}
+
+void SweepAndPrune::add_pair(unsigned int a, unsigned int b)
+{
+	const Proxy& pa = proxies[a];
+	const Proxy& pb = proxies[b];
+	const bool overlap = pa.min.x < pb.max.x && pb.min.x < pa.max.x && pa.min.y < pb.max.y && pb.min.y < pa.max.y;
+	if (overlap && pairs.insert(pair_key(a, b)).second)
+		begun_pairs.push_back({ pa.entity, pb.entity });
+}
+
+void SweepAndPrune::remove_pair(unsigned int a, unsigned int b)
+{
+	if (pairs.erase(pair_key(a, b)) > 0)
+		ended_pairs.push_back({ proxies[a].entity, proxies[b].entity });
+}
+
+void SweepAndPrune::remove_stale_proxies()
+{
+	bool any_stale = false;
+	for (const Proxy& proxy : proxies)
+		any_stale = any_stale || (proxy.used && proxy.stamp != stamp);
+	if (!any_stale)
+		return;
+
+	for (auto it = pairs.begin(); it != pairs.end();)
+	{
+		const unsigned int a = (unsigned int)(*it >> 32), b = (unsigned int)*it;
+		if (proxies[a].stamp != stamp || proxies[b].stamp != stamp)
+		{
+			ended_pairs.push_back({ proxies[a].entity, proxies[b].entity });
+			it = pairs.erase(it);
+		}
+		else
+			++it;
+	}
+
+	// Dropping endpoints keeps the rest in order
+	for (int axis = 0; axis < 2; axis++)
+		axes[axis].erase(std::remove_if(axes[axis].begin(), axes[axis].end(),
+			[this](const Endpoint& endpoint) { return proxies[endpoint.proxy].stamp != stamp; }), axes[axis].end());
+
+	for (unsigned int id = 0; id < proxies.size(); id++)
+	{
+		Proxy& proxy = proxies[id];
+		if (!proxy.used || proxy.stamp == stamp)
+			continue;
+		unsigned int* slot = lookup.find(proxy.entity);
+		if (slot != nullptr && *slot == id)
+			*slot = SPARSE_INVALID_INDEX;
+		proxy.used = false;
+		free_proxies.push_back(id);
+	}
+}
+
+void SweepAndPrune::sort_axis(int axis)
+{
+	std::vector<Endpoint>& endpoints = axes[axis];
+	for (Endpoint& endpoint : endpoints)
+	{
+		const Proxy& proxy = proxies[endpoint.proxy];
+		endpoint.value = endpoint.is_max ? proxy.max[axis] : proxy.min[axis];
+	}
+
+	// Insertion sort, a min moving below a max may begin an overlap, a max moving below a min ends one
+	for (size_t i = 1; i < endpoints.size(); i++)
+	{
+		const Endpoint moving = endpoints[i];
+		size_t j = i;
+		while (j > 0 && endpoints[j - 1].value > moving.value)
+		{
+			const Endpoint& passed = endpoints[j - 1];
+			if (passed.proxy != moving.proxy)
+			{
+				if (!moving.is_max && passed.is_max)
+					add_pair(moving.proxy, passed.proxy);
+				else if (moving.is_max && !passed.is_max)
+					remove_pair(moving.proxy, passed.proxy);
+			}
+			endpoints[j] = passed;
+			j--;
+		}
+		endpoints[j] = moving;
+	}
+}
+
+void SweepAndPrune::update_pairs()
+{
+	begun_pairs.clear();
+	ended_pairs.clear();
+	remove_stale_proxies();
+	sort_axis(0);
+	sort_axis(1);
+	stamp++;
+}
+
+void SweepAndPrune::find_pairs(std::vector<ProxyPair>& out) const
+{
+	for (uint64_t key : pairs)
+	{
+		const unsigned int a = proxies[(unsigned int)(key >> 32)].index;
+		const unsigned int b = proxies[(unsigned int)key].index;
+		out.push_back(a < b ? ProxyPair(a, b) : ProxyPair(b, a));
+	}
+}
+
+constexpr float DynamicAABBTree::FAT_MARGIN;
+constexpr float DynamicAABBTree::DISPLACEMENT_MULTIPLIER;
+
+bool AABB::intersects_segment(vec2 from, vec2 to) const
+{
+	float t_min = 0.f, t_max = 1.f;
+	const vec2 direction = to - from;
+	for (int axis = 0; axis < 2; axis++)
+	{
+		if (std::abs(direction[axis]) < 1e-6f)
+		{
+			if (from[axis] < min[axis] || from[axis] > max[axis])
+				return false;
+			continue;
+		}
+		float t0 = (min[axis] - from[axis]) / direction[axis];
+		float t1 = (max[axis] - from[axis]) / direction[axis];
+		if (t0 > t1)
+			std::swap(t0, t1);
+		t_min = std::max(t_min, t0);
+		t_max = std::min(t_max, t1);
+		if (t_min > t_max)
+			return false;
+	}
+	return true;
+}
+
+AABB merge(const AABB& a, const AABB& b)
+{
+	return { glm::min(a.min, b.min), glm::max(a.max, b.max) };
+}
+
+int DynamicAABBTree::allocate_node()
+{
+	int id;
+	if (free_list != NULL_NODE)
+	{
+		id = free_list;
+		free_list = nodes[id].parent;
+	}
+	else
+	{
+		id = (int)nodes.size();
+		nodes.push_back(Node());
+	}
+	Node& node = nodes[id];
+	node.parent = NULL_NODE;
+	node.child1 = NULL_NODE;
+	node.child2 = NULL_NODE;
+	node.height = 0;
+	node.user = 0;
+	return id;
+}
+
+void DynamicAABBTree::free_node(int id)
+{
+	nodes[id].parent = free_list;
+	nodes[id].height = -1;
+	free_list = id;
+}
+
+int DynamicAABBTree::create_proxy(const AABB& box, unsigned int user)
+{
+	const int id = allocate_node();
+	nodes[id].box = { box.min - vec2(FAT_MARGIN), box.max + vec2(FAT_MARGIN) };
+	nodes[id].user = user;
+	insert_leaf(id);
+	return id;
+}
+
+void DynamicAABBTree::destroy_proxy(int proxy)
+{
+	assert(nodes[proxy].is_leaf());
+	remove_leaf(proxy);
+	free_node(proxy);
+}
+
+bool DynamicAABBTree::move_proxy(int proxy, const AABB& box, vec2 displacement)
+{
+	AABB fat = { box.min - vec2(FAT_MARGIN), box.max + vec2(FAT_MARGIN) };
+
+	// Extend the fat box in the direction of motion
+	const vec2 d = displacement * DISPLACEMENT_MULTIPLIER;
+	for (int axis = 0; axis < 2; axis++)
+	{
+		if (d[axis] < 0.f)
+			fat.min[axis] += d[axis];
+		else
+			fat.max[axis] += d[axis];
+	}
+
+	// Keep the leaf while the box is inside its fat box, unless that has become far too large
+	const AABB& current = nodes[proxy].box;
+	if (current.contains(box))
+	{
+		const AABB huge = { fat.min - vec2(4.f * FAT_MARGIN), fat.max + vec2(4.f * FAT_MARGIN) };
+		if (huge.contains(current))
+			return false;
+	}
+
+	remove_leaf(proxy);
+	nodes[proxy].box = fat;
+	insert_leaf(proxy);
+	return true;
+}
+
+void DynamicAABBTree::insert_leaf(int leaf)
+{
+	if (root == NULL_NODE)
+	{
+		root = leaf;
+		nodes[root].parent = NULL_NODE;
+		return;
+	}
+
+	// Find the best sibling by the perimeter the tree would grow by
+	const AABB leaf_box = nodes[leaf].box;
+	int index = root;
+	while (!nodes[index].is_leaf())
+	{
+		const Node& node = nodes[index];
+		const float area = node.box.perimeter();
+		const float combined_area = merge(node.box, leaf_box).perimeter();
+
+		// Cost of creating a new parent for this node and the leaf, and of pushing the leaf further down
+		const float cost = 2.f * combined_area;
+		const float inheritance_cost = 2.f * (combined_area - area);
+
+		float child_cost[2];
+		const int children[2] = { node.child1, node.child2 };
+		for (int c = 0; c < 2; c++)
+		{
+			const Node& child = nodes[children[c]];
+			const float merged = merge(leaf_box, child.box).perimeter();
+			child_cost[c] = (child.is_leaf() ? merged : merged - child.box.perimeter()) + inheritance_cost;
+		}
+
+		if (cost < child_cost[0] && cost < child_cost[1])
+			break;
+		index = child_cost[0] < child_cost[1] ? children[0] : children[1];
+	}
+	const int sibling = index;
+
+	// Create a new parent for the sibling and the leaf
+	const int old_parent = nodes[sibling].parent;
+	const int new_parent = allocate_node();
+	nodes[new_parent].parent = old_parent;
+	nodes[new_parent].box = merge(leaf_box, nodes[sibling].box);
+	nodes[new_parent].height = nodes[sibling].height + 1;
+	nodes[new_parent].child1 = sibling;
+	nodes[new_parent].child2 = leaf;
+	nodes[sibling].parent = new_parent;
+	nodes[leaf].parent = new_parent;
+	if (old_parent == NULL_NODE)
+		root = new_parent;
+	else if (nodes[old_parent].child1 == sibling)
+		nodes[old_parent].child1 = new_parent;
+	else
+		nodes[old_parent].child2 = new_parent;
+
+	refit_upwards(nodes[leaf].parent);
+}
+
+void DynamicAABBTree::remove_leaf(int leaf)
+{
+	if (leaf == root)
+	{
+		root = NULL_NODE;
+		return;
+	}
+
+	// The sibling takes the place of the parent
+	const int parent = nodes[leaf].parent;
+	const int grand_parent = nodes[parent].parent;
+	const int sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+	free_node(parent);
+	if (grand_parent == NULL_NODE)
+	{
+		root = sibling;
+		nodes[sibling].parent = NULL_NODE;
+		return;
+	}
+	if (nodes[grand_parent].child1 == parent)
+		nodes[grand_parent].child1 = sibling;
+	else
+		nodes[grand_parent].child2 = sibling;
+	nodes[sibling].parent = grand_parent;
+	refit_upwards(grand_parent);
+}
+
+// Rebalance and update the boxes and heights from node 'id' up to the root
+void DynamicAABBTree::refit_upwards(int id)
+{
+	while (id != NULL_NODE)
+	{
+		id = balance(id);
+		Node& node = nodes[id];
+		node.height = 1 + std::max(nodes[node.child1].height, nodes[node.child2].height);
+		node.box = merge(nodes[node.child1].box, nodes[node.child2].box);
+		id = node.parent;
+	}
+}
+
+// If one subtree of node A is more than one level higher than the other, rotate its root up.
+// Returns the node that took the place of A.
+int DynamicAABBTree::balance(int a)
+{
+	Node& A = nodes[a];
+	if (A.is_leaf() || A.height < 2)
+		return a;
+
+	const int b = A.child1;
+	const int c = A.child2;
+	Node& B = nodes[b];
+	Node& C = nodes[c];
+	const int difference = C.height - B.height;
+
+	// Rotate C up, A takes the lower of C's children
+	if (difference > 1)
+	{
+		const int f = C.child1;
+		const int g = C.child2;
+		Node& F = nodes[f];
+		Node& G = nodes[g];
+
+		C.child1 = a;
+		C.parent = A.parent;
+		A.parent = c;
+		if (C.parent == NULL_NODE)
+			root = c;
+		else if (nodes[C.parent].child1 == a)
+			nodes[C.parent].child1 = c;
+		else
+			nodes[C.parent].child2 = c;
+
+		if (F.height > G.height)
+		{
+			C.child2 = f;
+			A.child2 = g;
+			G.parent = a;
+			A.box = merge(B.box, G.box);
+			C.box = merge(A.box, F.box);
+			A.height = 1 + std::max(B.height, G.height);
+			C.height = 1 + std::max(A.height, F.height);
+		}
+		else
+		{
+			C.child2 = g;
+			A.child2 = f;
+			F.parent = a;
+			A.box = merge(B.box, F.box);
+			C.box = merge(A.box, G.box);
+			A.height = 1 + std::max(B.height, F.height);
+			C.height = 1 + std::max(A.height, G.height);
+		}
+		return c;
+	}
+
+	// Rotate B up, A takes the lower of B's children
+	if (difference < -1)
+	{
+		const int d = B.child1;
+		const int e = B.child2;
+		Node& D = nodes[d];
+		Node& E = nodes[e];
+
+		B.child1 = a;
+		B.parent = A.parent;
+		A.parent = b;
+		if (B.parent == NULL_NODE)
+			root = b;
+		else if (nodes[B.parent].child1 == a)
+			nodes[B.parent].child1 = b;
+		else
+			nodes[B.parent].child2 = b;
+
+		if (D.height > E.height)
+		{
+			B.child2 = d;
+			A.child1 = e;
+			E.parent = a;
+			A.box = merge(C.box, E.box);
+			B.box = merge(A.box, D.box);
+			A.height = 1 + std::max(C.height, E.height);
+			B.height = 1 + std::max(A.height, D.height);
+		}
+		else
+		{
+			B.child2 = e;
+			A.child1 = d;
+			D.parent = a;
+			A.box = merge(C.box, D.box);
+			B.box = merge(A.box, E.box);
+			A.height = 1 + std::max(C.height, D.height);
+			B.height = 1 + std::max(A.height, E.height);
+		}
+		return b;
+	}
+
+	return a;
+}
+
+void DynamicAABBTree::find_pairs(std::vector<ProxyPair>& pairs) const
+{
+	// Query the tree with every leaf, each pair is found from both sides and kept from the lower id
+	for (int leaf = 0; leaf < (int)nodes.size(); leaf++)
+	{
+		if (nodes[leaf].height != 0)
+			continue;
+		const unsigned int user = nodes[leaf].user;
+		query(nodes[leaf].box, [&](int other) {
+			if (other > leaf)
+			{
+				const unsigned int other_user = nodes[other].user;
+				pairs.push_back(user < other_user ? ProxyPair(user, other_user) : ProxyPair(other_user, user));
+			}
+			return true;
+		});
+	}
+}
+
+void AABBTreeBroadphase::set_box(Entity entity, unsigned int index, vec2 min, vec2 max, vec2 displacement)
+{
+	unsigned int& slot = lookup.assure(entity);
+	if (slot != SPARSE_INVALID_INDEX && proxies[slot].used && proxies[slot].entity == entity)
+	{
+		Proxy& proxy = proxies[slot];
+		proxy.index = index;
+		proxy.stamp = stamp;
+		tree.move_proxy(proxy.node, { min, max }, displacement);
+		return;
+	}
+
+	// A new proxy, one of an older entity with the same index is left to update()
+	unsigned int id;
+	if (!free_proxies.empty())
+	{
+		id = free_proxies.back();
+		free_proxies.pop_back();
+		proxies[id] = { entity, index, DynamicAABBTree::NULL_NODE, stamp, true };
+	}
+	else
+	{
+		id = (unsigned int)proxies.size();
+		proxies.push_back({ entity, index, DynamicAABBTree::NULL_NODE, stamp, true });
+	}
+	proxies[id].node = tree.create_proxy({ min, max }, id);
+	slot = id;
+}
+
+void AABBTreeBroadphase::update()
+{
+	for (unsigned int id = 0; id < proxies.size(); id++)
+	{
+		Proxy& proxy = proxies[id];
+		if (!proxy.used || proxy.stamp == stamp)
+			continue;
+		tree.destroy_proxy(proxy.node);
+		unsigned int* slot = lookup.find(proxy.entity);
+		if (slot != nullptr && *slot == id)
+			*slot = SPARSE_INVALID_INDEX;
+		proxy.used = false;
+		free_proxies.push_back(id);
+	}
+	stamp++;
+}
+
+void AABBTreeBroadphase::find_pairs(std::vector<ProxyPair>& pairs) const
+{
+	// The tree pairs proxy ids, translate them to the indices of this step
+	proxy_pairs.clear();
+	tree.find_pairs(proxy_pairs);
+	for (const ProxyPair& pair : proxy_pairs)
+	{
+		const unsigned int a = proxies[pair.first].index;
+		const unsigned int b = proxies[pair.second].index;
+		pairs.push_back(a < b ? ProxyPair(a, b) : ProxyPair(b, a));
+	}
+}
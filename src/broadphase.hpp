@@ -0,0 +1,291 @@
+#pragma once
+
+#include <stdint.h>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "common.hpp"
+#include "tiny_ecs.hpp"
+
+// The ways the physics step can find the candidate pairs that reach collides()
+enum class BroadphaseMode {
+	BRUTE_FORCE = 0, // test all pairs
+	UNIFORM_GRID = BRUTE_FORCE + 1,
+	SWEEP_AND_PRUNE = UNIFORM_GRID + 1,
+	AABB_TREE = SWEEP_AND_PRUNE + 1,
+	MODE_COUNT = AABB_TREE + 1
+};
+const char* broadphase_name(BroadphaseMode mode);
+
+// A candidate pair, the proxy ids given on insert with first < second
+typedef std::pair<unsigned int, unsigned int> ProxyPair;
+
+// Axis aligned bounding box
+struct AABB
+{
+	vec2 min;
+	vec2 max;
+
+	bool overlaps(const AABB& other) const
+	{
+		return min.x < other.max.x && other.min.x < max.x && min.y < other.max.y && other.min.y < max.y;
+	}
+	bool contains(const AABB& other) const
+	{
+		return min.x <= other.min.x && min.y <= other.min.y && other.max.x <= max.x && other.max.y <= max.y;
+	}
+	float perimeter() const
+	{
+		return 2.f * (max.x - min.x + max.y - min.y);
+	}
+	// Whether the segment from 'from' to 'to' passes through the box (slab test)
+	bool intersects_segment(vec2 from, vec2 to) const;
+};
+AABB merge(const AABB& a, const AABB& b);
+
+// Buckets axis aligned bounding boxes into a grid of square cells covering the given area, only
+// boxes sharing a cell are candidate pairs. Boxes outside the area are clamped into the border
+// cells. Boxes covering more than MAX_CELLS cells (e.g. the background) are not bucketed but kept
+// in a separate list and paired with every other box.
+// The grid is rebuilt every step with a counting sort, all buffers are kept between steps.
+class UniformGrid
+{
+public:
+	static const int MAX_CELLS = 16;
+
+	UniformGrid(float width, float height, float cell_size);
+
+	void clear();
+	void insert(unsigned int proxy, vec2 min, vec2 max);
+
+	// Appends every candidate pair exactly once
+	void find_pairs(std::vector<ProxyPair>& pairs);
+
+private:
+	struct Box
+	{
+		unsigned int proxy;
+		int x0, y0, x1, y1; // covered cells, inclusive
+	};
+
+	float cell_size;
+	int columns;
+	int rows;
+
+	std::vector<Box> boxes;
+	std::vector<unsigned int> oversized; // indices into boxes
+	std::vector<unsigned int> cell_start; // cell c holds cell_entries[cell_start[c], cell_start[c + 1])
+	std::vector<unsigned int> cell_entries; // indices into boxes
+
+	int cell_x(float x) const;
+	int cell_y(float y) const;
+	bool is_oversized(const Box& box) const;
+};
+
+// Sort and sweep over the x and y axis. The box endpoints are kept sorted across steps and
+// re-sorted with an insertion sort, which is close to O(n) when the order along the axes barely
+// changes between frames. Every swap of two endpoints of different boxes is where an overlap can
+// begin or end, so the set of overlapping pairs is updated incrementally.
+class SweepAndPrune
+{
+public:
+	// Set the box of an entity for the next update_pairs(), 'index' is what the pairs report for
+	// the entity (e.g. its index in registry.motions). Entities that are not set between two
+	// updates are removed.
+	void set_box(Entity entity, unsigned int index, vec2 min, vec2 max);
+
+	// Re-sort the endpoints and update the overlapping pairs and the begin/end events
+	void update_pairs();
+
+	// Appends the currently overlapping pairs, as the indices given to set_box
+	void find_pairs(std::vector<ProxyPair>& pairs) const;
+
+	// The entity pairs that started and stopped overlapping in the last update_pairs()
+	const std::vector<std::pair<Entity, Entity>>& begun() const { return begun_pairs; }
+	const std::vector<std::pair<Entity, Entity>>& ended() const { return ended_pairs; }
+
+private:
+	struct Proxy
+	{
+		Entity entity;
+		unsigned int index;
+		vec2 min, max;
+		unsigned int stamp; // the update in which the box was last set
+		bool used;
+	};
+
+	struct Endpoint
+	{
+		float value;
+		unsigned int proxy;
+		bool is_max;
+	};
+
+	std::vector<Proxy> proxies;
+	std::vector<unsigned int> free_proxies;
+	SparseIndex lookup; // Entity -> proxy
+	std::vector<Endpoint> axes[2];
+
+	// The overlapping proxy pairs, the smaller proxy id in the high bits
+	std::unordered_set<uint64_t> pairs;
+	std::vector<std::pair<Entity, Entity>> begun_pairs, ended_pairs;
+	unsigned int stamp = 1;
+
+	void add_pair(unsigned int a, unsigned int b);
+	void remove_pair(unsigned int a, unsigned int b);
+	void remove_stale_proxies();
+	void sort_axis(int axis);
+};
+
+// Dynamic bounding volume hierarchy of fat boxes, after Box2D's b2DynamicTree. The leaves store a
+// box enlarged by a margin and by the predicted motion, so an object only has to be re-inserted
+// once it leaves its fat box. Inserting picks the sibling with the smallest perimeter growth and
+// the tree is kept balanced with rotations on the way back to the root.
+class DynamicAABBTree
+{
+public:
+	static const int NULL_NODE = -1;
+	static constexpr float FAT_MARGIN = 8.f; // px
+	static constexpr float DISPLACEMENT_MULTIPLIER = 4.f;
+
+	// Returns the id of the new leaf, 'user' is passed back by the queries
+	int create_proxy(const AABB& box, unsigned int user);
+	void destroy_proxy(int proxy);
+
+	// Returns true if the leaf had to be re-inserted because 'box' left its fat box
+	bool move_proxy(int proxy, const AABB& box, vec2 displacement);
+
+	unsigned int get_user(int proxy) const { return nodes[proxy].user; }
+	void set_user(int proxy, unsigned int user) { nodes[proxy].user = user; }
+	const AABB& get_fat_box(int proxy) const { return nodes[proxy].box; }
+	int get_height() const { return root == NULL_NODE ? 0 : nodes[root].height; }
+
+	// Calls func(proxy) for every leaf whose fat box overlaps 'box', stops if func returns false
+	template <typename Func>
+	void query(const AABB& box, Func func) const
+	{
+		stack.clear();
+		if (root != NULL_NODE)
+			stack.push_back(root);
+		while (!stack.empty())
+		{
+			const int id = stack.back();
+			stack.pop_back();
+			const Node& node = nodes[id];
+			if (!node.box.overlaps(box))
+				continue;
+			if (node.is_leaf())
+			{
+				if (!func(id))
+					return;
+			}
+			else
+			{
+				stack.push_back(node.child1);
+				stack.push_back(node.child2);
+			}
+		}
+	}
+
+	// Calls func(proxy) for every leaf whose fat box the segment passes, stops if func returns false
+	template <typename Func>
+	void ray_cast(vec2 from, vec2 to, Func func) const
+	{
+		stack.clear();
+		if (root != NULL_NODE)
+			stack.push_back(root);
+		while (!stack.empty())
+		{
+			const int id = stack.back();
+			stack.pop_back();
+			const Node& node = nodes[id];
+			if (!node.box.intersects_segment(from, to))
+				continue;
+			if (node.is_leaf())
+			{
+				if (!func(id))
+					return;
+			}
+			else
+			{
+				stack.push_back(node.child1);
+				stack.push_back(node.child2);
+			}
+		}
+	}
+
+	// Appends the pairs of leaves with overlapping fat boxes, as their user values
+	void find_pairs(std::vector<ProxyPair>& pairs) const;
+
+private:
+	struct Node
+	{
+		AABB box;
+		int parent; // the next free node while on the free list
+		int child1;
+		int child2;
+		int height; // 0 for leaves, -1 for free nodes
+		unsigned int user;
+
+		bool is_leaf() const { return child1 == NULL_NODE; }
+	};
+
+	std::vector<Node> nodes;
+	int root = NULL_NODE;
+	int free_list = NULL_NODE;
+	mutable std::vector<int> stack; // traversal scratch of the queries
+
+	int allocate_node();
+	void free_node(int id);
+	void insert_leaf(int leaf);
+	void remove_leaf(int leaf);
+	int balance(int id);
+	void refit_upwards(int id);
+};
+
+// The tree as broadphase of the physics step, one leaf per entity that is kept across steps
+class AABBTreeBroadphase
+{
+public:
+	// Like SweepAndPrune::set_box, 'displacement' is the expected motion until the next step
+	void set_box(Entity entity, unsigned int index, vec2 min, vec2 max, vec2 displacement);
+
+	// Removes the entities that were not set since the last update
+	void update();
+
+	void find_pairs(std::vector<ProxyPair>& pairs) const;
+
+	// Calls func(Entity) for the entities whose fat box overlaps the region or is hit by the segment,
+	// as of the last update. The caller does the exact test.
+	template <typename Func>
+	void query_region(vec2 min, vec2 max, Func func) const
+	{
+		tree.query({ min, max }, [&](int node) { func(proxies[tree.get_user(node)].entity); return true; });
+	}
+	template <typename Func>
+	void ray_cast(vec2 from, vec2 to, Func func) const
+	{
+		tree.ray_cast(from, to, [&](int node) { func(proxies[tree.get_user(node)].entity); return true; });
+	}
+
+	const DynamicAABBTree& get_tree() const { return tree; }
+
+private:
+	struct Proxy
+	{
+		Entity entity;
+		unsigned int index; // in registry.motions during the last step
+		int node;
+		unsigned int stamp;
+		bool used;
+	};
+
+	DynamicAABBTree tree;
+	std::vector<Proxy> proxies; // tree leaves store the proxy id as user value
+	std::vector<unsigned int> free_proxies;
+	SparseIndex lookup; // Entity -> proxy
+	unsigned int stamp = 1;
+
+	mutable std::vector<ProxyPair> proxy_pairs;
+};
@@ -5,6 +5,7 @@
 #include "../ext/stb_image/stb_image.h"
 
 // stlib
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 
@@ -119,3 +120,50 @@ bool Mesh::loadFromOBJFile(std::string obj_path, std::vector<ColoredVertex>& out
 
 	return true;
 }
+
+void Mesh::build_hull()
+{
+	std::vector<vec2> points;
+	points.reserve(vertices.size());
+	for (const ColoredVertex& vertex : vertices)
+		points.push_back(vec2(vertex.position));
+	build_hull(std::move(points));
+}
+
+// Andrew's monotone chain
+void Mesh::build_hull(std::vector<vec2> points)
+{
+	hull.clear();
+	hull_normals.clear();
+	std::sort(points.begin(), points.end(), [](vec2 a, vec2 b) { return a.x != b.x ? a.x < b.x : a.y < b.y; });
+	points.erase(std::unique(points.begin(), points.end()), points.end());
+	if (points.size() < 3)
+	{
+		hull = points;
+		return;
+	}
+
+	auto cross = [](vec2 o, vec2 a, vec2 b) { return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x); };
+	std::vector<vec2> chain(2 * points.size());
+	size_t k = 0;
+	for (size_t i = 0; i < points.size(); i++) // lower hull
+	{
+		while (k >= 2 && cross(chain[k - 2], chain[k - 1], points[i]) <= 0)
+			k--;
+		chain[k++] = points[i];
+	}
+	for (size_t i = points.size() - 1, lower = k + 1; i-- > 0;) // upper hull
+	{
+		while (k >= lower && cross(chain[k - 2], chain[k - 1], points[i]) <= 0)
+			k--;
+		chain[k++] = points[i];
+	}
+	chain.resize(k - 1); // the last point is the first one again
+	hull = chain;
+
+	for (size_t i = 0; i < hull.size(); i++)
+	{
+		const vec2 edge = hull[(i + 1) % hull.size()] - hull[i];
+		hull_normals.push_back(normalize(vec2(edge.y, -edge.x)));
+	}
+}
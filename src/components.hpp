@@ -54,15 +54,6 @@ struct Motion {
 	EntityType type = EntityType::Generic;
 };
 
-// Stucture to store collision information
-struct Collision
-{
-	// Note, the first object is stored in the ECS container.entities
-	Entity other; // the second object involved in the collision
-	Collision(Entity& other) { this->other = other; };
-
-};
-
 // Data structure for toggling debug mode
 struct Debug {
 	bool in_debug_mode = 0;
@@ -79,7 +70,7 @@ struct ScreenState
 // A struct to refer to debugging graphics in the ECS
 struct DebugComponent
 {
-	// Note, an empty struct has size 1
+	// Note, empty structs are stored as tags in the registry, without per-entity storage
 };
 
 // A timer that will be associated to dying chicken
@@ -109,6 +100,36 @@ struct Mesh
 	vec2 original_size = {1,1};
 	std::vector<ColoredVertex> vertices;
 	std::vector<uint16_t> vertex_indices;
+
+	// Convex hull of the mesh in local xy, counterclockwise, and the outward normal of the edge
+	// from hull[i] to hull[i + 1]. Built once at load for the narrowphase.
+	std::vector<vec2> hull;
+	std::vector<vec2> hull_normals;
+
+	// Build the hull from the vertices, or from the given points for meshes that only live on the GPU
+	void build_hull();
+	void build_hull(std::vector<vec2> points);
+};
+
+// The narrowphase shape of an entity, sized and placed by its Motion like the sprite. Entities
+// without a Collider (e.g. the background) never collide.
+enum class ColliderShape {
+	AABB = 0, // the box of the scale, ignores the angle
+	CIRCLE = AABB + 1,
+	OBB = CIRCLE + 1, // the box of the scale, rotated by the angle
+	POLYGON = OBB + 1, // the hull of a mesh
+	SHAPE_COUNT = POLYGON + 1
+};
+
+struct Collider
+{
+	ColliderShape shape = ColliderShape::AABB;
+
+	// CIRCLE: radius relative to the smaller side of the scale, 0.5 fits the circle into the box
+	float radius = 0.5f;
+
+	// POLYGON: the mesh whose hull is used
+	const Mesh* mesh = nullptr;
 };
 
 // Background component for if an entity represents a background image
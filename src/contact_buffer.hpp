@@ -0,0 +1,85 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "tiny_ecs.hpp"
+
+// Order of entities by index, the generation only breaks ties. The sparse arrays are keyed by the
+// index, so this is the order that walks them front to back.
+inline bool entity_index_less(Entity a, Entity b)
+{
+	return a.index() != b.index() ? a.index() < b.index() : a.generation() < b.generation();
+}
+
+// A contact between two entities, 'a' holds the entity with the smaller index
+struct Contact
+{
+	Entity a;
+	Entity b;
+
+	bool operator<(const Contact& other) const
+	{
+		return a != other.a ? entity_index_less(a, other.a) : entity_index_less(b, other.b);
+	}
+	bool operator==(const Contact& other) const
+	{
+		return a == other.a && b == other.b;
+	}
+};
+
+// The contacts found by one physics step, each pair stored once. The buffer is preallocated and
+// clear() keeps its memory, so filling it every frame does not allocate.
+class ContactBuffer
+{
+	std::vector<Contact> contacts;
+
+public:
+	explicit ContactBuffer(size_t capacity = 256)
+	{
+		contacts.reserve(capacity);
+	}
+
+	void add(Entity a, Entity b)
+	{
+		if (entity_index_less(b, a))
+			std::swap(a, b);
+		contacts.push_back({ a, b });
+	}
+
+	// Order by entity, so that all contacts of an entity are adjacent and consumers walk the
+	// component arrays in a steady order. 'dedup' drops pairs that were reported more than once,
+	// e.g. by a broadphase that finds a pair in several cells.
+	void sort(bool dedup = false)
+	{
+		std::sort(contacts.begin(), contacts.end());
+		if (dedup)
+			contacts.erase(std::unique(contacts.begin(), contacts.end()), contacts.end());
+	}
+
+	void clear() { contacts.clear(); }
+	size_t size() const { return contacts.size(); }
+	bool empty() const { return contacts.empty(); }
+	const Contact& operator[](size_t i) const { return contacts[i]; }
+	std::vector<Contact>::const_iterator begin() const { return contacts.begin(); }
+	std::vector<Contact>::const_iterator end() const { return contacts.end(); }
+
+	// Calls func(Entity with A, Entity with B) for the contacts between an entity with component A
+	// and one with component B, filtered by the entity signatures of the registry
+	// contacts.each<Player, Minion>(registry, [](Entity player, Entity minion) { ... });
+	template <typename A, typename B, typename RegistryType, typename Func>
+	void each(const RegistryType& registry, Func func) const
+	{
+		const ComponentMask mask_a = RegistryType::template mask_of<A>();
+		const ComponentMask mask_b = RegistryType::template mask_of<B>();
+		for (const Contact& contact : contacts)
+		{
+			const ComponentMask signature_a = registry.signature(contact.a);
+			const ComponentMask signature_b = registry.signature(contact.b);
+			if ((signature_a & mask_a).any() && (signature_b & mask_b).any())
+				func(contact.a, contact.b);
+			else if ((signature_b & mask_a).any() && (signature_a & mask_b).any())
+				func(contact.b, contact.a);
+		}
+	}
+};
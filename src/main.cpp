@@ -31,11 +31,14 @@ int main()
 
 	// initialize the main systems
 	renderer.init(window);
-	world.init(&renderer);
+	world.init(&renderer, &physics);
 
 	// variable timestep loop
 	auto t = Clock::now();
 	while (!world.is_over()) {
+		// Component changes from here on are stamped with the new frame
+		registry.advance_frame();
+
 		// Processes system messages, if this wasn't present the window would become unresponsive
 		glfwPollEvents();
 
@@ -45,9 +48,12 @@ int main()
 			(float)(std::chrono::duration_cast<std::chrono::microseconds>(now - t)).count() / 1000;
 		t = now;
 
+		// Structural changes recorded in registry.commands are applied at the sync points in between the systems
 		world.step(elapsed_ms);
+		registry.flush_commands();
 		physics.step(elapsed_ms);
 		world.handle_collisions();
+		registry.flush_commands();
 
 		renderer.draw();
 	}
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <vector>
+
+#include "common.hpp"
+#include "tiny_ecs.hpp"
+#include "components.hpp"
+
+// Structure-of-arrays storage of Motion, selected with
+// template <> struct component_array<Motion> { typedef MotionSoA type; };
+// Each field is a separate array, so that loops over many entities only pull the fields they use
+// into cache, e.g. integration reads position and velocity, the broadphase position and scale.
+// The container hands out MotionRef proxies instead of Motion&, see ComponentContainer::reference.
+
+// Proxy for the element of a MotionSoA, its members refer into the field arrays and have the same
+// names as those of Motion. Copying a MotionRef copies the references, assigning to it the values.
+// Like a reference into a std::vector, it is invalidated when the container grows or is packed.
+struct MotionRef
+{
+	vec2& position;
+	float& angle;
+	vec2& velocity;
+	vec2& scale;
+	EntityType& type;
+
+	MotionRef(vec2& position, float& angle, vec2& velocity, vec2& scale, EntityType& type)
+		: position(position), angle(angle), velocity(velocity), scale(scale), type(type) {}
+	MotionRef(const MotionRef&) = default;
+
+	operator Motion() const
+	{
+		Motion motion;
+		motion.position = position;
+		motion.angle = angle;
+		motion.velocity = velocity;
+		motion.scale = scale;
+		motion.type = type;
+		return motion;
+	}
+
+	const MotionRef& operator=(const Motion& motion) const
+	{
+		position = motion.position;
+		angle = motion.angle;
+		velocity = motion.velocity;
+		scale = motion.scale;
+		type = motion.type;
+		return *this;
+	}
+	const MotionRef& operator=(const MotionRef& other) const
+	{
+		return *this = Motion(other);
+	}
+};
+
+class MotionSoA;
+
+// What ComponentContainer<Motion>::try_get returns, nullptr or an element of a MotionSoA
+class MotionPtr
+{
+	MotionSoA* array = nullptr;
+	size_t i = 0;
+
+	// Holds the proxy for operator->
+	struct Arrow
+	{
+		MotionRef ref;
+		const MotionRef* operator->() const { return &ref; }
+	};
+
+public:
+	MotionPtr(std::nullptr_t = nullptr) {}
+	MotionPtr(MotionSoA* array, size_t i) : array(array), i(i) {}
+
+	MotionRef operator*() const;
+	Arrow operator->() const { return { **this }; }
+
+	explicit operator bool() const { return array != nullptr; }
+	bool operator==(std::nullptr_t) const { return array == nullptr; }
+	bool operator!=(std::nullptr_t) const { return array != nullptr; }
+};
+
+class MotionSoA
+{
+public:
+	typedef Motion value_type;
+	typedef MotionRef reference;
+	typedef MotionPtr pointer;
+
+	// The field arrays, element i of each belongs to the same entity
+	std::vector<vec2> position;
+	std::vector<float> angle;
+	std::vector<vec2> velocity;
+	std::vector<vec2> scale;
+	std::vector<EntityType> type;
+
+	size_t size() const { return position.size(); }
+	bool empty() const { return position.empty(); }
+	size_t capacity() const { return position.capacity(); }
+
+	MotionRef operator[](size_t i) { return { position[i], angle[i], velocity[i], scale[i], type[i] }; }
+	MotionRef back() { return (*this)[size() - 1]; }
+
+	void push_back(const Motion& motion)
+	{
+		position.push_back(motion.position);
+		angle.push_back(motion.angle);
+		velocity.push_back(motion.velocity);
+		scale.push_back(motion.scale);
+		type.push_back(motion.type);
+	}
+
+	void pop_back()
+	{
+		position.pop_back();
+		angle.pop_back();
+		velocity.pop_back();
+		scale.pop_back();
+		type.pop_back();
+	}
+
+	void clear()
+	{
+		position.clear();
+		angle.clear();
+		velocity.clear();
+		scale.clear();
+		type.clear();
+	}
+
+	void reserve(size_t size)
+	{
+		position.reserve(size);
+		angle.reserve(size);
+		velocity.reserve(size);
+		scale.reserve(size);
+		type.reserve(size);
+	}
+};
+
+inline MotionRef MotionPtr::operator*() const
+{
+	return (*array)[i];
+}
+
+// The ComponentContainer operations on the array, see array_element
+inline MotionPtr array_element(MotionSoA& array, size_t i)
+{
+	return MotionPtr(&array, i);
+}
+
+inline void array_swap(MotionSoA& array, size_t i, size_t j)
+{
+	std::swap(array.position[i], array.position[j]);
+	std::swap(array.angle[i], array.angle[j]);
+	std::swap(array.velocity[i], array.velocity[j]);
+	std::swap(array.scale[i], array.scale[j]);
+	std::swap(array.type[i], array.type[j]);
+}
+
+// Snapshots hold the field arrays one after the other
+inline void array_save(SnapshotWriter& out, const MotionSoA& array)
+{
+	out.write_array(array.position);
+	out.write_array(array.angle);
+	out.write_array(array.velocity);
+	out.write_array(array.scale);
+	out.write_array(array.type);
+}
+
+inline void array_load(SnapshotReader& in, MotionSoA& array)
+{
+	in.read_array(array.position);
+	in.read_array(array.angle);
+	in.read_array(array.velocity);
+	in.read_array(array.scale);
+	in.read_array(array.type);
+}
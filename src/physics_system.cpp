@@ -1,15 +1,10 @@
 // internal
 #include "physics_system.hpp"
 #include "world_init.hpp"
+#include "sat.hpp"
 #include <iostream>
 #include <vector>
-vec2 normalize(const vec2&);
 float duration = 0;
-bool isParallel(const std::vector<vec2>&, const vec2&);
-std::pair<float, float> projectOntoAxis(const std::vector<vec2>&, const vec2&);
-bool projectionsOverlap(const std::pair<float, float>&, const std::pair<float, float>&);
-bool checkMeshCollisionSAT(Mesh*, const Motion&);
-std::vector<vec2> getRectangleEdge(const Motion&, std::vector<vec2>&);
 // Returns the local bounding coordinates scaled by the current size of the entity
 vec2 get_bounding_box(const Motion& motion)
 {
@@ -17,44 +12,16 @@ vec2 get_bounding_box(const Motion& motion)
 	return { abs(motion.scale.x), abs(motion.scale.y) };
 }
 
-// This is a SUPER APPROXIMATE check that puts a circle around the bounding boxes and sees
-// if the center point of either object is inside the other's bounding-box-circle. You can
-// surely implement a more accurate detection
+// The narrowphase of each pair of collider shapes, indexed by the shapes of the first and second
+// entity. Each function takes the entities in the order of its name, e.g. circle vs. AABB.
+typedef bool (*NarrowphaseFunc)(const Motion&, const Collider&, const Motion&, const Collider&);
+extern const NarrowphaseFunc narrowphase_table[(int)ColliderShape::SHAPE_COUNT][(int)ColliderShape::SHAPE_COUNT];
 
-
-bool collides(const Motion& motion1, const Motion& motion2)
+bool collides(const Motion& motion1, const Collider& collider1, const Motion& motion2, const Collider& collider2)
 {
-	const vec2 other_halfBB = get_bounding_box(motion1) / 2.f;
-	const vec2 my_halfBB = get_bounding_box(motion2) / 2.f;
-	vec2 center_dis = motion1.position - motion2.position;
-	//std::cout << other_halfBB.x << std::endl;
-	//std::cout << other_halfBB.y << std::endl;
-
-	if (abs(center_dis.x) < (my_halfBB.x + other_halfBB.x)
-		&& abs(center_dis.y) < (my_halfBB.y + other_halfBB.y)) {
-
-		if (motion1.type == EntityType::Player) {
-			Entity& entity = registry.players.entities[0];
-			Mesh* mesh = registry.meshPtrs.get(entity);
-			mesh->vertices[0].position;
-			//std::cout << mesh->vertices[0].position.x << std::endl;
-			//std::cout << mesh->vertices[0].position.y << std::endl;
-
-			return checkMeshCollisionSAT(mesh, motion2);
-		}
-		else if(motion2.type == EntityType::Player) {
-			Entity& entity = registry.players.entities[0];
-			Mesh* mesh = registry.meshPtrs.get(entity);
-			return checkMeshCollisionSAT(mesh, motion1);
-		}
-		else {
-			return true;
-		}
-	}
-
-	return false;
-
+	return narrowphase_table[(int)collider1.shape][(int)collider2.shape](motion1, collider1, motion2, collider2);
 }
+
 float lerp(float start, float end, float t) {
 
 	return start * (1 - t) + end * t;
@@ -65,57 +32,59 @@ void PhysicsSystem::step(float elapsed_ms)
 {
 	// Move bug based on how much time has passed, this is to (partially) avoid
 	// having entities move at different speed based on the machine.
-	auto& motion_registry = registry.motions;
 	static float accumulatedTime = 0.0f;
 	accumulatedTime += elapsed_ms;
-	for(uint i = 0; i< motion_registry.size(); i++)
-	{	
-		Motion& motion = motion_registry.components[i];
-		Entity entity = motion_registry.entities[i];
-		float step_seconds = elapsed_ms / 1000.f;
-		
-		if (registry.players.has(entity)) {
-			// Vicky M1: idle animation
-			const float cycleDuration = 4000.0f;
-			float cycleTime = fmod(accumulatedTime, cycleDuration) / cycleDuration;
-
-
-			float normalizedTime;
-			if (cycleTime < 0.5f) {
-				normalizedTime = cycleTime / 0.5f;
-			}
-			else {
-				normalizedTime = (1.0f - cycleTime) / 0.5f;
-			}
-
-
-			const float maxScale = 1.1f;
-
-			motion.scale.x = lerp(BLENDY_BB_WIDTH, maxScale * BLENDY_BB_WIDTH, normalizedTime);
-			motion.scale.y = lerp(BLENDY_BB_HEIGHT, maxScale * BLENDY_BB_HEIGHT, normalizedTime);
-			
-			
-			float new_x = motion.velocity.x * step_seconds + motion.position.x;
-			float new_y = motion.velocity.y * step_seconds + motion.position.y;
-			vec2 bounding_box = { abs(motion.scale.x), abs(motion.scale.y) };
-			float half_width = bounding_box.x / 2.f;
-			float half_height = bounding_box.y / 2.f;
-			if (new_x - half_width > 0 && new_x + half_width < window_width_px) {
-				motion.position.x = new_x;
-			}
-
-			if (new_y - half_height > 0 && new_y + half_height < window_height_px) {
-				motion.position.y = new_y;
-			}
+	float step_seconds = elapsed_ms / 1000.f;
+
+	registry.query<Motion, Player>().each([&](Entity entity, MotionRef motion, Player&) {
+		registry.motions.patch(entity); // the idle animation changes the scale every step
+
+		// Vicky M1: idle animation
+		const float cycleDuration = 4000.0f;
+		float cycleTime = fmod(accumulatedTime, cycleDuration) / cycleDuration;
+
+
+		float normalizedTime;
+		if (cycleTime < 0.5f) {
+			normalizedTime = cycleTime / 0.5f;
 		}
 		else {
-			motion.position.x += motion.velocity.x * step_seconds;
-			motion.position.y += motion.velocity.y * step_seconds;
+			normalizedTime = (1.0f - cycleTime) / 0.5f;
 		}
-		
 
 
+		const float maxScale = 1.1f;
+
+		motion.scale.x = lerp(BLENDY_BB_WIDTH, maxScale * BLENDY_BB_WIDTH, normalizedTime);
+		motion.scale.y = lerp(BLENDY_BB_HEIGHT, maxScale * BLENDY_BB_HEIGHT, normalizedTime);
 		
+		
+		float new_x = motion.velocity.x * step_seconds + motion.position.x;
+		float new_y = motion.velocity.y * step_seconds + motion.position.y;
+		vec2 bounding_box = { abs(motion.scale.x), abs(motion.scale.y) };
+		float half_width = bounding_box.x / 2.f;
+		float half_height = bounding_box.y / 2.f;
+		if (new_x - half_width > 0 && new_x + half_width < window_width_px) {
+			motion.position.x = new_x;
+		}
+
+		if (new_y - half_height > 0 && new_y + half_height < window_height_px) {
+			motion.position.y = new_y;
+		}
+	});
+
+	// Integrate all other enabled motions, a walk over the position and velocity arrays only
+	ComponentContainer<Motion> &motion_container = registry.motions;
+	MotionSoA& motions = motion_container.components;
+	for (uint i = 0; i < motions.size(); i++)
+	{
+		// static entities (background, light) keep their change stamp
+		if (!motion_container.enabled[i] || (motions.velocity[i].x == 0 && motions.velocity[i].y == 0))
+			continue;
+		if (registry.players.has(motion_container.entities[i]))
+			continue;
+		motion_container.versions[i] = current_frame; // see patch()
+		motions.position[i] += motions.velocity[i] * step_seconds;
 	}
 
 	// Vicky TODO M1: more blood loss, the screen will trun into black, until dead
@@ -129,27 +98,35 @@ void PhysicsSystem::step(float elapsed_ms)
 	// DON'T WORRY ABOUT THIS UNTIL ASSIGNMENT 2
 	// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
 
-	// Check for collisions between all moving entities
-    ComponentContainer<Motion> &motion_container = registry.motions;
-	for(uint i = 0; i<motion_container.components.size(); i++)
-	{
-		Motion& motion_i = motion_container.components[i];
-		Entity entity_i = motion_container.entities[i];
-		
-		// note starting j at i+1 to compare all (i,j) pairs only once (and to not compare with itself)
-		for(uint j = i+1; j<motion_container.components.size(); j++)
+	// Check for collisions between all entities with an enabled Motion and Collider, the broadphase
+	// narrows the pairs down
+	colliders.resize(motion_container.components.size());
+	for (uint i = 0; i < motion_container.components.size(); i++)
+		colliders[i] = motion_container.enabled[i] ? registry.colliders.try_get_enabled(motion_container.entities[i]) : nullptr;
+
+	auto test_pair = [this, &motion_container](uint i, uint j) {
+		if (colliders[i] == nullptr || colliders[j] == nullptr)
+			return;
+		if (collides(motion_container.components[i], *colliders[i], motion_container.components[j], *colliders[j]))
 		{
-			Motion& motion_j = motion_container.components[j];
-			if (collides(motion_i, motion_j))
-			{
-				Entity entity_j = motion_container.entities[j];
-				// Create a collisions event
-				// We are abusing the ECS system a bit in that we potentially insert muliple collisions for the same entity
-				registry.collisions.emplace_with_duplicates(entity_i, entity_j);
-				registry.collisions.emplace_with_duplicates(entity_j, entity_i);
-			}
+			// Create a collisions event, each pair is only recorded once
+			registry.contacts.add(motion_container.entities[i], motion_container.entities[j]);
 		}
+	};
+	if (broadphase == BroadphaseMode::BRUTE_FORCE)
+	{
+		// note starting j at i+1 to compare all (i,j) pairs only once (and to not compare with itself)
+		for (uint i = 0; i < motion_container.components.size(); i++)
+			for (uint j = i + 1; j < motion_container.components.size(); j++)
+				test_pair(i, j);
 	}
+	else
+	{
+		find_candidate_pairs(step_seconds);
+		for (const ProxyPair& pair : candidate_pairs)
+			test_pair(pair.first, pair.second);
+	}
+	registry.contacts.sort();
 
 	// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
 	// TODO A2: HANDLE EGG collisions HERE
@@ -158,106 +135,231 @@ void PhysicsSystem::step(float elapsed_ms)
 }
 
 
-bool checkMeshCollisionSAT(Mesh* mesh, const Motion& motion) {
-	//std::cout << "SAT check" << std::endl;
-
-	std::vector<vec2> axises;
-	std::vector<vec2> edges;
-	std::vector<vec2> rectangle_shape;
-	std::vector<vec2> rectangle = getRectangleEdge(motion, rectangle_shape);
-	std::vector<vec2> shape;
-	bool collision = false;
-	for (size_t i = 0; i < mesh->vertex_indices.size(); i += 3) {
-		axises.clear();
-		edges.clear();
-		shape.clear();
-		axises = rectangle;
-		if (i + 2 < mesh->vertex_indices.size()) {
-			const ColoredVertex& v1 = mesh->vertices[mesh->vertex_indices[i]];
-			const ColoredVertex& v2 = mesh->vertices[mesh->vertex_indices[i + 1]];
-			const ColoredVertex& v3 = mesh->vertices[mesh->vertex_indices[i + 2]];
-			shape.push_back(v1.position);
-			shape.push_back(v2.position);
-			shape.push_back(v3.position);
-
-			edges.push_back({ v2.position.x - v1.position.x, v2.position.y - v1.position.y });
-			edges.push_back({ v3.position.x - v2.position.x, v3.position.y - v2.position.y });
-			edges.push_back({ v1.position.x - v3.position.x, v1.position.y - v3.position.y });
-			for (const auto& edge : edges) {
-				if (axises.size() == 0) {
-					axises.push_back(normalize(edge));
-				}
-				else if (!isParallel(axises, edge)) {
-					axises.push_back(normalize(edge));
-				}
-			} 
+void PhysicsSystem::find_candidate_pairs(float step_seconds)
+{
+	// Entities without a collider are left out of the broadphase, the boxes are built from the
+	// position and scale arrays of the motions only
+	ComponentContainer<Motion>& motion_container = registry.motions;
+	const MotionSoA& motions = motion_container.components;
+	candidate_pairs.clear();
+
+	switch (broadphase)
+	{
+	case BroadphaseMode::UNIFORM_GRID:
+		grid.clear();
+		for (uint i = 0; i < motion_container.components.size(); i++)
+		{
+			if (colliders[i] == nullptr)
+				continue;
+			const vec2 half_bb = abs(motions.scale[i]) / 2.f;
+			grid.insert(i, motions.position[i] - half_bb, motions.position[i] + half_bb);
 		}
-		for (const vec2 axis: axises) {
-			std::pair<float, float> polygonProjection = projectOntoAxis(shape, axis);
-			std::pair<float, float> rectangleProjection = projectOntoAxis(rectangle_shape, axis);
-			if (!projectionsOverlap(polygonProjection, rectangleProjection)) {
+		grid.find_pairs(candidate_pairs);
+		break;
+
+	case BroadphaseMode::SWEEP_AND_PRUNE:
+		for (uint i = 0; i < motion_container.components.size(); i++)
+		{
+			if (colliders[i] == nullptr)
 				continue;
-			}
-			collision = true;
+			const vec2 half_bb = abs(motions.scale[i]) / 2.f;
+			sweep_and_prune.set_box(motion_container.entities[i], i, motions.position[i] - half_bb, motions.position[i] + half_bb);
 		}
-		
+		sweep_and_prune.update_pairs();
+		sweep_and_prune.find_pairs(candidate_pairs);
+		break;
+
+	case BroadphaseMode::AABB_TREE:
+		for (uint i = 0; i < motion_container.components.size(); i++)
+		{
+			if (colliders[i] == nullptr)
+				continue;
+			const vec2 half_bb = abs(motions.scale[i]) / 2.f;
+			aabb_tree.set_box(motion_container.entities[i], i, motions.position[i] - half_bb, motions.position[i] + half_bb, motions.velocity[i] * step_seconds);
+		}
+		aabb_tree.update();
+		aabb_tree.find_pairs(candidate_pairs);
+		break;
+
+	default:
+		break;
 	}
-	return collision;
+}
 
+static AABB get_box(const Motion& motion)
+{
+	const vec2 half_bb = get_bounding_box(motion) / 2.f;
+	return { motion.position - half_bb, motion.position + half_bb };
 }
 
-vec2 normalize(const vec2& v) {
-	float length = std::sqrt(v.x * v.x + v.y * v.y);
-	return { v.x / length, v.y / length };
+void PhysicsSystem::query_region(vec2 min, vec2 max, std::vector<Entity>& out) const
+{
+	const AABB region = { min, max };
+	auto test = [&](Entity entity) {
+		const MotionPtr motion = registry.motions.try_get_enabled(entity);
+		if (motion != nullptr && registry.colliders.try_get_enabled(entity) != nullptr && get_box(*motion).overlaps(region))
+			out.push_back(entity);
+	};
+	if (broadphase == BroadphaseMode::AABB_TREE)
+		aabb_tree.query_region(min, max, test);
+	else
+		for (Entity entity : registry.motions.entities)
+			test(entity);
 }
 
+void PhysicsSystem::ray_cast(vec2 from, vec2 to, std::vector<Entity>& out) const
+{
+	auto test = [&](Entity entity) {
+		const MotionPtr motion = registry.motions.try_get_enabled(entity);
+		if (motion != nullptr && registry.colliders.try_get_enabled(entity) != nullptr && get_box(*motion).intersects_segment(from, to))
+			out.push_back(entity);
+	};
+	if (broadphase == BroadphaseMode::AABB_TREE)
+		aabb_tree.ray_cast(from, to, test);
+	else
+		for (Entity entity : registry.motions.entities)
+			test(entity);
+}
 
-bool isParallel(const std::vector<vec2>& axis, const vec2& edge) {
-	//std::cout << "check isParallel" << std::endl;
+static float circle_radius(const Motion& motion, const Collider& collider)
+{
+	const vec2 size = get_bounding_box(motion);
+	return collider.radius * std::min(size.x, size.y);
+}
 
-	for (const auto& existing_axis : axis) {
-		float crossProduct = edge.x * existing_axis.y - edge.y * existing_axis.x;
-		if (std::abs(crossProduct) < 0.0000001) {
-			return true;
+// The shape as polygon in world space, POLYGON falls back to the box if the mesh has no usable hull.
+// The axes of the shape are added to 'axes' if given: x and y for AABBs, the rotated x and y for
+// OBBs and the precomputed hull normals, transformed by the motion, for polygons.
+static void to_polygon(const Motion& motion, const Collider& collider, ConvexPolygon& out, SeparatingAxes* axes = nullptr)
+{
+	const vec2 half_bb = get_bounding_box(motion) / 2.f;
+	if (collider.shape == ColliderShape::AABB)
+	{
+		out = ConvexPolygon::box(motion.position - half_bb, motion.position + half_bb);
+		if (axes != nullptr)
+		{
+			axes->add({ 1.f, 0.f });
+			axes->add({ 0.f, 1.f });
+		}
+		return;
+	}
+
+	// Same order as the render transform: scale, rotate, translate
+	const float c = cos(motion.angle);
+	const float s = sin(motion.angle);
+	auto rotate = [&](vec2 p) {
+		return vec2(c * p.x - s * p.y, s * p.x + c * p.y);
+	};
+	out.count = 0;
+	const Mesh* mesh = collider.mesh;
+	if (collider.shape == ColliderShape::POLYGON && mesh != nullptr && mesh->hull.size() >= 3 && mesh->hull.size() <= ConvexPolygon::MAX_VERTICES)
+	{
+		for (const vec2& p : mesh->hull)
+			out.add(rotate(p * motion.scale) + motion.position);
+		if (axes != nullptr)
+		{
+			// Normals transform with the inverse scale, scaled by the determinant to avoid the division
+			for (const vec2& normal : mesh->hull_normals)
+				axes->add(rotate({ normal.x * motion.scale.y, normal.y * motion.scale.x }));
 		}
+		return;
+	}
+	out.add(rotate({ -half_bb.x, -half_bb.y }) + motion.position);
+	out.add(rotate({ half_bb.x, -half_bb.y }) + motion.position);
+	out.add(rotate({ half_bb.x, half_bb.y }) + motion.position);
+	out.add(rotate({ -half_bb.x, half_bb.y }) + motion.position);
+	if (axes != nullptr)
+	{
+		axes->add({ c, s });
+		axes->add({ -s, c });
 	}
-	return false;
 }
 
-std::vector<vec2> getRectangleEdge(const Motion& motion, std::vector<vec2>& shape) {
-
-	//std::cout << "check getRectangleEdge" << std::endl;
-	std::vector<vec2> rectangle(4);
-	float halfWidth = abs(motion.scale.x) / 2.0f;
-	float halfHeight = abs(motion.scale.y) / 2.0f;
-	vec2 topLeft = { motion.position.x - halfWidth, motion.position.y + halfHeight };
-	vec2 topRight = { motion.position.x + halfWidth, motion.position.y + halfHeight };
-	vec2 bottomLeft = { motion.position.x - halfWidth, motion.position.y - halfHeight };
-	vec2 bottomRight = { motion.position.x + halfWidth, motion.position.y - halfHeight };
-	shape.push_back(topLeft);
-	shape.push_back(topRight);
-	shape.push_back(bottomLeft);
-	shape.push_back(bottomRight);
-
-	rectangle[0] = normalize({ topRight.x - topLeft.x, topRight.y - topLeft.y }); // Top edge
-	rectangle[1] = normalize({ bottomRight.x - topRight.x, bottomRight.y - topRight.y }); // Right edge
-	rectangle[2] = normalize({ bottomLeft.x - bottomRight.x, bottomLeft.y - bottomRight.y }); // Bottom edge
-	rectangle[3] = normalize({ topLeft.x - bottomLeft.x, topLeft.y - bottomLeft.y }); // Left edge
-	return rectangle;
+// Whether the circle overlaps the box centered at the origin, by the closest point of the box
+static bool circle_box_local(vec2 center, float radius, vec2 half_bb)
+{
+	const vec2 closest = clamp(center, -half_bb, half_bb);
+	const vec2 d = center - closest;
+	return dot(d, d) < radius * radius;
 }
 
-//projectOntoAxis function reference https://dyn4j.org/2010/01/sat/
-std::pair<float, float> projectOntoAxis(const std::vector<vec2>& shape, const vec2& axis) {
-	//std::cout << "check projection" << std::endl;
-	float minProj = dot(shape[0], axis);
-	float maxProj = minProj;
-	for (const auto& point : shape) {
-		float proj = dot(point, axis);
-		minProj = std::min(minProj, proj);
-		maxProj = std::max(maxProj, proj);
+static bool aabb_aabb(const Motion& motion1, const Collider&, const Motion& motion2, const Collider&)
+{
+	const vec2 half_bb = (get_bounding_box(motion1) + get_bounding_box(motion2)) / 2.f;
+	const vec2 center_dis = motion1.position - motion2.position;
+	return abs(center_dis.x) < half_bb.x && abs(center_dis.y) < half_bb.y;
+}
+
+static bool circle_circle(const Motion& motion1, const Collider& collider1, const Motion& motion2, const Collider& collider2)
+{
+	const float radius = circle_radius(motion1, collider1) + circle_radius(motion2, collider2);
+	const vec2 d = motion1.position - motion2.position;
+	return dot(d, d) < radius * radius;
+}
+
+static bool circle_aabb(const Motion& motion1, const Collider& collider1, const Motion& motion2, const Collider&)
+{
+	return circle_box_local(motion1.position - motion2.position, circle_radius(motion1, collider1), get_bounding_box(motion2) / 2.f);
+}
+
+static bool circle_obb(const Motion& motion1, const Collider& collider1, const Motion& motion2, const Collider&)
+{
+	// Rotate the circle center into the frame of the box
+	const vec2 d = motion1.position - motion2.position;
+	const float c = cos(motion2.angle);
+	const float s = sin(motion2.angle);
+	const vec2 local = { c * d.x + s * d.y, -s * d.x + c * d.y };
+	return circle_box_local(local, circle_radius(motion1, collider1), get_bounding_box(motion2) / 2.f);
+}
+
+static bool circle_polygon(const Motion& motion1, const Collider& collider1, const Motion& motion2, const Collider& collider2)
+{
+	ConvexPolygon polygon;
+	to_polygon(motion2, collider2, polygon);
+	const vec2 center = motion1.position;
+	const float radius = circle_radius(motion1, collider1);
+
+	// Inside if the center is on the same side of every edge, otherwise by the closest edge
+	bool inside = true;
+	float winding = 0.f;
+	float closest = radius * radius;
+	for (int i = 0; i < polygon.count; i++)
+	{
+		const vec2 p = polygon.vertex(i);
+		const vec2 edge = polygon.vertex(i + 1 < polygon.count ? i + 1 : 0) - p;
+		const float side = edge.x * (center.y - p.y) - edge.y * (center.x - p.x);
+		if (side * winding < 0.f)
+			inside = false;
+		if (side != 0.f)
+			winding = side;
+
+		const float t = clamp(dot(center - p, edge) / std::max(dot(edge, edge), 1e-12f), 0.f, 1.f);
+		const vec2 d = center - (p + t * edge);
+		closest = std::min(closest, dot(d, d));
 	}
-	return { minProj, maxProj };
+	return inside || closest < radius * radius;
+}
+
+// Any pair of AABB, OBB and POLYGON, by the SAT kernel
+static bool polygon_polygon(const Motion& motion1, const Collider& collider1, const Motion& motion2, const Collider& collider2)
+{
+	ConvexPolygon polygon1, polygon2;
+	SeparatingAxes axes;
+	to_polygon(motion1, collider1, polygon1, &axes);
+	to_polygon(motion2, collider2, polygon2, &axes);
+	return polygons_overlap(polygon1, polygon2, axes);
 }
-bool projectionsOverlap(const std::pair<float, float>& proj1, const std::pair<float, float>& proj2) {
-	return !(proj1.second < proj2.first || proj2.second < proj1.first);
-}
\ No newline at end of file
+
+template <NarrowphaseFunc Func>
+static bool swapped(const Motion& motion1, const Collider& collider1, const Motion& motion2, const Collider& collider2)
+{
+	return Func(motion2, collider2, motion1, collider1);
+}
+
+// Rows and columns in the order of ColliderShape: AABB, CIRCLE, OBB, POLYGON
+const NarrowphaseFunc narrowphase_table[(int)ColliderShape::SHAPE_COUNT][(int)ColliderShape::SHAPE_COUNT] = {
+	{ aabb_aabb, swapped<circle_aabb>, polygon_polygon, polygon_polygon },
+	{ circle_aabb, circle_circle, circle_obb, circle_polygon },
+	{ polygon_polygon, swapped<circle_obb>, polygon_polygon, polygon_polygon },
+	{ polygon_polygon, swapped<circle_polygon>, polygon_polygon, polygon_polygon },
+};
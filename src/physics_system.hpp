@@ -4,6 +4,7 @@
 #include "tiny_ecs.hpp"
 #include "components.hpp"
 #include "tiny_ecs_registry.hpp"
+#include "broadphase.hpp"
 
 // A simple physics system that moves rigid bodies and checks for collision
 class PhysicsSystem
@@ -12,6 +13,35 @@ public:
 	void step(float elapsed_ms);
 
 	PhysicsSystem()
+		: grid((float)window_width_px, (float)window_height_px, GRID_CELL_SIZE)
 	{
 	}
+
+	// Select how candidate pairs are found, can be changed at any time
+	void set_broadphase(BroadphaseMode mode) { broadphase = mode; }
+	BroadphaseMode get_broadphase() const { return broadphase; }
+
+	// Gameplay queries (e.g. pickups, lasers) over the boxes of the entities with an enabled Motion
+	// and Collider. The AABB tree answers them when it is the broadphase, otherwise all motions are
+	// scanned.
+	void query_region(vec2 min, vec2 max, std::vector<Entity>& out) const;
+	void ray_cast(vec2 from, vec2 to, std::vector<Entity>& out) const;
+
+private:
+	// A bit larger than a minion
+	static constexpr float GRID_CELL_SIZE = 128.f;
+
+	BroadphaseMode broadphase = BroadphaseMode::UNIFORM_GRID;
+	UniformGrid grid;
+	SweepAndPrune sweep_and_prune;
+	AABBTreeBroadphase aabb_tree;
+
+	// Candidate pairs of the broadphase as indices into registry.motions, kept between steps
+	std::vector<ProxyPair> candidate_pairs;
+
+	// The Collider of each entry of registry.motions during the step, nullptr if it has none or either is disabled
+	std::vector<const Collider*> colliders;
+
+	// Fills candidate_pairs, not used for BRUTE_FORCE
+	void find_candidate_pairs(float step_seconds);
 };
\ No newline at end of file
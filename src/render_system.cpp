@@ -106,27 +106,26 @@ void RenderSystem::configure_base_uniforms(Entity entity, const mat3& projection
 	setUsesNormalMap(render_request.used_normal_map != TEXTURE_ASSET_ID::TEXTURE_COUNT, program);
 
 	// Lighting Config
-	const LightSource& directional_light_component = registry.lightSources.get(directional_light);
-	const Motion& motion = registry.motions.get(directional_light);
+	MotionRef motion = registry.motions.get(directional_light);
 
 	// Configuring lightPosition 
 	GLint lightPosition_uloc = glGetUniformLocation(program, "lightPosition");
-	glUniform3fv(lightPosition_uloc, 1, (float*)& vec3(motion.position, directional_light_component.z_depth));
+	glUniform3fv(lightPosition_uloc, 1, (float*)& vec3(motion.position, directional_light_component->z_depth));
 	gl_has_errors();
 
 	// Configuring lightColor
 	GLint lightColor_uloc = glGetUniformLocation(program, "lightColor");
-	glUniform3fv(lightColor_uloc, 1, (float*)&directional_light_component.light_color);
+	glUniform3fv(lightColor_uloc, 1, (float*)&directional_light_component->light_color);
 	gl_has_errors();
 
 	// Configuring shinyness
 	GLint shininess_uloc = glGetUniformLocation(program, "shininess");
-	glUniform1f(shininess_uloc, (float) directional_light_component.shininess);
+	glUniform1f(shininess_uloc, (float) directional_light_component->shininess);
 	gl_has_errors();
 
 	// Configuring ambientIntensity
 	GLint ambientIntensity_uloc = glGetUniformLocation(program, "ambientIntensity");
-	glUniform1f(ambientIntensity_uloc, (float)directional_light_component.ambientIntensity);
+	glUniform1f(ambientIntensity_uloc, (float)directional_light_component->ambientIntensity);
 	gl_has_errors();
 
 	// Get number of indices from index buffer, which has elements uint16_t
@@ -148,21 +147,39 @@ void RenderSystem::configure_base_uniforms(Entity entity, const mat3& projection
 	gl_has_errors();
 }
 
+void RenderSystem::setDirectionalLight(const Entity& light)
+{
+	directional_light = light;
+	directional_light_component = &registry.lightSources.get(light);
+}
+
+const Transform& RenderSystem::get_transform(Entity entity, const Motion& motion)
+{
+	if (entity.index() >= transform_cache.size())
+		transform_cache.resize(entity.index() + 1);
+
+	// Rebuild if the slot belongs to another entity (re-used index) or the motion was patched since
+	CachedTransform& cached = transform_cache[entity.index()];
+	if (cached.entity_id != (unsigned int)entity || registry.motions.changed_since(entity, cached.frame))
+	{
+		cached.entity_id = entity;
+		cached.frame = current_frame;
+		cached.transform = Transform();
+		cached.transform.translate(motion.position);
+		cached.transform.rotate(motion.angle);
+		cached.transform.scale(motion.scale);
+	}
+	return cached.transform;
+}
+
 // TODO: A number of code smells in this function that need to be cleaned up
-void RenderSystem::drawTexturedMesh(Entity entity,
+void RenderSystem::drawTexturedMesh(Entity entity, const Motion& motion, const RenderRequest& render_request,
 									const mat3 &projection)
 {
-	Motion &motion = registry.motions.get(entity);
 	// Transformation code, see Rendering and Transformation in the template
 	// specification for more info Incrementally updates transformation matrix,
 	// thus ORDER IS IMPORTANT
-	Transform transform;
-	transform.translate(motion.position);
-	transform.rotate(motion.angle);
-	transform.scale(motion.scale);
-
-	assert(registry.renderRequests.has(entity));
-	const RenderRequest &render_request = registry.renderRequests.get(entity);
+	const Transform& transform = get_transform(entity, motion);
 
 	const GLuint used_effect_enum = (GLuint)render_request.used_effect;
 	assert(used_effect_enum != (GLuint)EFFECT_ASSET_ID::EFFECT_COUNT);
@@ -285,15 +302,10 @@ void RenderSystem::draw()
 							  // sprites back to front
 	gl_has_errors();
 	mat3 projection_2D = createProjectionMatrix();
-	// Draw all textured meshes that have a position and size component
-	for (Entity entity : registry.renderRequests.entities)
-	{
-		if (!registry.motions.has(entity))
-			continue;
-		// Note, its not very efficient to access elements indirectly via the entity
-		// albeit iterating through all Sprites in sequence. A good point to optimize
-		drawTexturedMesh(entity, projection_2D);
-	}
+	// Draw all textured meshes that have a position and size component, walking the render group in lockstep
+	registry.render_group.each([&](Entity entity, MotionRef motion, RenderRequest& render_request, Mesh*) {
+		drawTexturedMesh(entity, motion, render_request, projection_2D);
+	});
 
 	// Truely render to the screen
 	drawToScreen();
@@ -83,11 +83,15 @@ public:
 	// Directional Light
 	Entity& getDirectionalLight() { return directional_light; }
 
-	void setDirectionalLight(const Entity& light) { directional_light = light; }
+	// The light needs its LightSource component already, a pointer to it is kept for drawing
+	void setDirectionalLight(const Entity& light);
 
 private:
+	// Cached Transform of an entity, only rebuilt when its Motion was patched since it was cached
+	const Transform& get_transform(Entity entity, const Motion& motion);
+
 	// Internal drawing functions for each entity type
-	void drawTexturedMesh(Entity entity, const mat3& projection);
+	void drawTexturedMesh(Entity entity, const Motion& motion, const RenderRequest& render_request, const mat3& projection);
 	void drawToScreen();
 
 	
@@ -109,6 +113,16 @@ private:
 
 	Entity screen_state_entity;
 	Entity directional_light;
+	const LightSource* directional_light_component = nullptr; // stable, LightSource is in paged storage
+
+	// Transform cache by entity index, the id tells apart entities that re-use an index
+	struct CachedTransform
+	{
+		unsigned int entity_id = 0;
+		unsigned int frame = 0;
+		Transform transform;
+	};
+	std::vector<CachedTransform> transform_cache;
 };
 
 bool loadEffectFromFile(
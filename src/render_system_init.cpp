@@ -129,6 +129,7 @@ void RenderSystem::initializeGlMeshes()
 			meshes[(int)geom_index].vertices,
 			meshes[(int)geom_index].vertex_indices,
 			meshes[(int)geom_index].original_size);
+		meshes[(int)geom_index].build_hull();
 
 		bindVBOandIBO(geom_index,
 			meshes[(int)geom_index].vertices, 
@@ -163,6 +164,12 @@ void RenderSystem::initializeGlGeometryBuffers()
 	const std::vector<uint16_t> textured_indices = { 0, 3, 1, 1, 3, 2 };
 	bindVBOandIBO(GEOMETRY_BUFFER_ID::SPRITE, textured_vertices, textured_indices);
 
+	// The sprite has no CPU side vertices, its hull is the quad
+	std::vector<vec2> sprite_points;
+	for (const TexturedVertex& vertex : textured_vertices)
+		sprite_points.push_back(vec2(vertex.position));
+	meshes[(int)GEOMETRY_BUFFER_ID::SPRITE].build_hull(sprite_points);
+
 	////////////////////////
 	// Initialize egg
 	std::vector<ColoredVertex> egg_vertices;
@@ -187,6 +194,7 @@ void RenderSystem::initializeGlGeometryBuffers()
 	int geom_index = (int)GEOMETRY_BUFFER_ID::EGG;
 	meshes[geom_index].vertices = egg_vertices;
 	meshes[geom_index].vertex_indices = egg_indices;
+	meshes[geom_index].build_hull();
 	bindVBOandIBO(GEOMETRY_BUFFER_ID::EGG, meshes[geom_index].vertices, meshes[geom_index].vertex_indices);
 
 	//////////////////////////////////
@@ -211,6 +219,7 @@ void RenderSystem::initializeGlGeometryBuffers()
 	geom_index = (int)GEOMETRY_BUFFER_ID::DEBUG_LINE;
 	meshes[geom_index].vertices = line_vertices;
 	meshes[geom_index].vertex_indices = line_indices;
+	meshes[geom_index].build_hull();
 	bindVBOandIBO(GEOMETRY_BUFFER_ID::DEBUG_LINE, line_vertices, line_indices);
 
 	///////////////////////////////////////////////////////
@@ -0,0 +1,123 @@
+// internal
+#include "sat.hpp"
+
+#include <algorithm>
+#include <limits>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define SAT_USE_SSE 1
+#include <xmmintrin.h>
+#endif
+
+ConvexPolygon ConvexPolygon::box(glm::vec2 min, glm::vec2 max)
+{
+	ConvexPolygon polygon;
+	polygon.add({ min.x, min.y });
+	polygon.add({ max.x, min.y });
+	polygon.add({ max.x, max.y });
+	polygon.add({ min.x, max.y });
+	return polygon;
+}
+
+void SeparatingAxes::add_normals(const ConvexPolygon& polygon)
+{
+	for (int i = 0; i < polygon.count; i++)
+	{
+		const int next = i + 1 < polygon.count ? i + 1 : 0;
+		add({ polygon.y[next] - polygon.y[i], polygon.x[i] - polygon.x[next] });
+	}
+}
+
+namespace
+{
+	void project(const ConvexPolygon& polygon, float axis_x, float axis_y, float& out_min, float& out_max)
+	{
+		out_min = std::numeric_limits<float>::max();
+		out_max = -std::numeric_limits<float>::max();
+		for (int i = 0; i < polygon.count; i++)
+		{
+			const float projection = polygon.x[i] * axis_x + polygon.y[i] * axis_y;
+			out_min = std::min(out_min, projection);
+			out_max = std::max(out_max, projection);
+		}
+	}
+
+	// Whether the projections onto axis i are disjoint
+	bool separated_on(const ConvexPolygon& a, const ConvexPolygon& b, const SeparatingAxes& axes, int i)
+	{
+		float a_min, a_max, b_min, b_max;
+		project(a, axes.x[i], axes.y[i], a_min, a_max);
+		project(b, axes.x[i], axes.y[i], b_min, b_max);
+		return a_max <= b_min || b_max <= a_min;
+	}
+
+#ifdef SAT_USE_SSE
+	// Projects the polygon onto four axes at once
+	void project4(const ConvexPolygon& polygon, __m128 axis_x, __m128 axis_y, __m128& out_min, __m128& out_max)
+	{
+		out_min = _mm_set1_ps(std::numeric_limits<float>::max());
+		out_max = _mm_set1_ps(-std::numeric_limits<float>::max());
+		for (int i = 0; i < polygon.count; i++)
+		{
+			const __m128 projection = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(polygon.x[i]), axis_x), _mm_mul_ps(_mm_set1_ps(polygon.y[i]), axis_y));
+			out_min = _mm_min_ps(out_min, projection);
+			out_max = _mm_max_ps(out_max, projection);
+		}
+	}
+#endif
+}
+
+bool polygons_overlap_scalar(const ConvexPolygon& a, const ConvexPolygon& b, const SeparatingAxes& axes)
+{
+	if (a.count == 0 || b.count == 0)
+		return false;
+	for (int i = 0; i < axes.count; i++)
+		if (separated_on(a, b, axes, i))
+			return false;
+	return true;
+}
+
+bool polygons_overlap_scalar(const ConvexPolygon& a, const ConvexPolygon& b)
+{
+	SeparatingAxes axes;
+	axes.add_normals(a);
+	axes.add_normals(b);
+	return polygons_overlap_scalar(a, b, axes);
+}
+
+bool polygons_overlap(const ConvexPolygon& a, const ConvexPolygon& b, const SeparatingAxes& axes)
+{
+#ifdef SAT_USE_SSE
+	if (a.count == 0 || b.count == 0)
+		return false;
+
+	int i = 0;
+	for (; i + 4 <= axes.count; i += 4)
+	{
+		const __m128 axis_x = _mm_load_ps(axes.x + i);
+		const __m128 axis_y = _mm_load_ps(axes.y + i);
+		__m128 a_min, a_max, b_min, b_max;
+		project4(a, axis_x, axis_y, a_min, a_max);
+		project4(b, axis_x, axis_y, b_min, b_max);
+		const __m128 separated = _mm_or_ps(_mm_cmple_ps(a_max, b_min), _mm_cmple_ps(b_max, a_min));
+		if (_mm_movemask_ps(separated) != 0)
+			return false;
+	}
+
+	// The last axes that don't fill a group
+	for (; i < axes.count; i++)
+		if (separated_on(a, b, axes, i))
+			return false;
+	return true;
+#else
+	return polygons_overlap_scalar(a, b, axes);
+#endif
+}
+
+bool polygons_overlap(const ConvexPolygon& a, const ConvexPolygon& b)
+{
+	SeparatingAxes axes;
+	axes.add_normals(a);
+	axes.add_normals(b);
+	return polygons_overlap(a, b, axes);
+}
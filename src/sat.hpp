@@ -0,0 +1,58 @@
+#pragma once
+
+// Separating axis test for small convex polygons. Only depends on glm, so it can be used and
+// benchmarked without the rest of the game.
+
+#include <glm/vec2.hpp>
+
+// Convex polygon with a fixed capacity and the coordinates stored as separate arrays, so that
+// nothing is allocated per test and the kernel can load the vertices directly
+struct ConvexPolygon
+{
+	static const int MAX_VERTICES = 64;
+
+	int count = 0;
+	alignas(16) float x[MAX_VERTICES];
+	alignas(16) float y[MAX_VERTICES];
+
+	// Vertices in order around the polygon, either winding
+	void add(glm::vec2 p)
+	{
+		x[count] = p.x;
+		y[count] = p.y;
+		count++;
+	}
+	glm::vec2 vertex(int i) const { return { x[i], y[i] }; }
+
+	static ConvexPolygon box(glm::vec2 min, glm::vec2 max);
+};
+
+// The axes to test, they need not be normalized
+struct SeparatingAxes
+{
+	static const int CAPACITY = 2 * ConvexPolygon::MAX_VERTICES;
+
+	int count = 0;
+	alignas(16) float x[CAPACITY];
+	alignas(16) float y[CAPACITY];
+
+	void add(glm::vec2 axis)
+	{
+		x[count] = axis.x;
+		y[count] = axis.y;
+		count++;
+	}
+
+	// The edge normals of the polygon
+	void add_normals(const ConvexPolygon& polygon);
+};
+
+// Whether the two polygons overlap on all the axes, touching counts as separated. Four axes are
+// projected at once with SSE where it is available and the test stops at the first group with a
+// separating axis. Without axes, the edge normals of both polygons are used.
+bool polygons_overlap(const ConvexPolygon& a, const ConvexPolygon& b, const SeparatingAxes& axes);
+bool polygons_overlap(const ConvexPolygon& a, const ConvexPolygon& b);
+
+// The same tests without SIMD, also used when SSE is not available
+bool polygons_overlap_scalar(const ConvexPolygon& a, const ConvexPolygon& b, const SeparatingAxes& axes);
+bool polygons_overlap_scalar(const ConvexPolygon& a, const ConvexPolygon& b);
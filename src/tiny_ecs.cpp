@@ -2,4 +2,5 @@
 #include "tiny_ecs.hpp"
 
 // All we need to store besides the containers is the id of every entity and callbacks to be able to remove entities across containers
-unsigned int Entity::id_count = 1;
\ No newline at end of file
+EntityManager entity_manager;
+unsigned int current_frame = 1;
\ No newline at end of file
@@ -1,87 +1,690 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <bitset>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
 #include <unordered_map>
 #include <set>
 #include <functional>
 #include <typeindex>
+#include <typeinfo>
 #include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// A copy of the registry state in one contiguous buffer, see Registry::snapshot()
+typedef std::vector<char> Snapshot;
+
+// Arrays in a snapshot start at offsets aligned for any component type, so they can be read in place
+const size_t SNAPSHOT_ALIGNMENT = 16;
+
+template <typename T, size_t PageSize>
+class PagedVector;
+
+// Appends arrays to a snapshot, each one as its element count followed by the raw bytes
+struct SnapshotWriter
+{
+	Snapshot buffer;
+
+	// Append without aligning, to continue the previous write
+	void append(const void* data, size_t size)
+	{
+		const size_t offset = buffer.size();
+		buffer.resize(offset + size);
+		if (size > 0)
+			memcpy(&buffer[offset], data, size);
+	}
+
+	void write(const void* data, size_t size)
+	{
+		buffer.resize((buffer.size() + SNAPSHOT_ALIGNMENT - 1) & ~(SNAPSHOT_ALIGNMENT - 1));
+		append(data, size);
+	}
+
+	template <typename T, typename Allocator>
+	void write_array(const std::vector<T, Allocator>& array)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be written to a snapshot");
+		const uint64_t count = array.size();
+		write(&count, sizeof(count));
+		write(array.data(), array.size() * sizeof(T));
+	}
+
+	// Paged arrays are written page by page, they read back like any other array
+	template <typename T, size_t PageSize>
+	void write_array(const PagedVector<T, PageSize>& array)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be written to a snapshot");
+		const uint64_t count = array.size();
+		write(&count, sizeof(count));
+		write(nullptr, 0);
+		for (size_t first = 0; first < array.size(); first += PageSize)
+			append(&array[first], std::min(PageSize, array.size() - first) * sizeof(T));
+	}
+};
+
+// Reads the arrays of a snapshot back in the order they were written
+struct SnapshotReader
+{
+	const Snapshot& buffer;
+	size_t offset = 0;
+
+	SnapshotReader(const Snapshot& buffer) : buffer(buffer) {}
+
+	const char* read(size_t size)
+	{
+		offset = (offset + SNAPSHOT_ALIGNMENT - 1) & ~(SNAPSHOT_ALIGNMENT - 1);
+		assert(offset + size <= buffer.size() && "Snapshot is truncated");
+		const char* data = buffer.data() + offset;
+		offset += size;
+		return data;
+	}
+
+	// Replaces the contents of 'array', a single bulk copy for trivially copyable types
+	template <typename Array>
+	void read_array(Array& array)
+	{
+		typedef typename Array::value_type T;
+		uint64_t count;
+		memcpy(&count, read(sizeof(count)), sizeof(count));
+		const T* data = reinterpret_cast<const T*>(read((size_t)count * sizeof(T)));
+		array.assign(data, data + count);
+	}
+};
+
+// An entity id packs an index (low bits), which is re-used once the entity is released, and a
+// generation (high bits), which is bumped on every release so that stale handles can be detected
+const unsigned int ENTITY_INDEX_BITS = 20;
+const unsigned int ENTITY_INDEX_MASK = (1u << ENTITY_INDEX_BITS) - 1;
+const unsigned int ENTITY_GENERATION_MASK = ~0u >> ENTITY_INDEX_BITS;
 
 // Unique identifyer for all entities
 class Entity
 {
 	unsigned int id;
-	static unsigned int id_count; // starts from 1, entit 0 is the default initialization
+	explicit Entity(unsigned int id) : id(id) {}
+	friend class EntityManager;
+public:
+	Entity(); // takes the next free id from the entity manager, index 0 is the default initialization
+	operator unsigned int() const { return id; } // this enables automatic casting to int
+	unsigned int index() const { return id & ENTITY_INDEX_MASK; }
+	unsigned int generation() const { return id >> ENTITY_INDEX_BITS; }
+};
+
+// Hands out entity ids and recycles the indices of released entities through a free list,
+// so that the index space (and all tables indexed by it) stays as large as the live population
+class EntityManager
+{
+	// The current generation of every index handed out so far
+	std::vector<unsigned int> generations;
+	// Released indices that are waiting to be re-used
+	std::vector<unsigned int> free_indices;
+	// The lowest generation the next release of an index may hand out, raised by load() for
+	// entities restored below a generation issued after the snapshot. Empty until then.
+	std::vector<unsigned int> release_floor;
+public:
+	EntityManager() : generations(1, 0) {} // index 0 is reserved
+
+	Entity create()
+	{
+		unsigned int index;
+		if (!free_indices.empty())
+		{
+			index = free_indices.back();
+			free_indices.pop_back();
+		}
+		else
+		{
+			index = (unsigned int)generations.size();
+			assert(index <= ENTITY_INDEX_MASK && "Ran out of entity indices");
+			generations.push_back(0);
+		}
+		return Entity((generations[index] << ENTITY_INDEX_BITS) | index);
+	}
+
+	// Check that the entity was not released since it was created
+	bool alive(Entity e) const
+	{
+		return e.index() != 0 && e.index() < generations.size() && generations[e.index()] == e.generation();
+	}
+
+	// Invalidate all handles to the entity and mark its index for re-use
+	void release(Entity e)
+	{
+		if (!alive(e))
+			return;
+		unsigned int next = generations[e.index()] + 1;
+		if (e.index() < release_floor.size())
+			next = std::max(next, release_floor[e.index()]);
+		generations[e.index()] = next & ENTITY_GENERATION_MASK;
+		free_indices.push_back(e.index());
+	}
+
+	// Number of live entities
+	size_t size() const { return generations.size() - 1 - free_indices.size(); }
+
+	// Number of indices handed out so far, an upper bound for all index based tables
+	size_t capacity() const { return generations.size(); }
+
+	// Bytes allocated for the generation table and the free list
+	size_t memory_bytes() const
+	{
+		return (generations.capacity() + free_indices.capacity() + release_floor.capacity()) * sizeof(unsigned int);
+	}
+
+	// Create 'count' entities at once and append them to 'out', growing the tables only once
+	void create(size_t count, std::vector<Entity>& out)
+	{
+		out.reserve(out.size() + count);
+		if (count > free_indices.size())
+			generations.reserve(generations.size() + count - free_indices.size());
+		for (size_t i = 0; i < count; i++)
+			out.push_back(create());
+	}
+
+	void save(SnapshotWriter& out) const
+	{
+		out.write_array(generations);
+		out.write_array(free_indices);
+	}
+
+	// Makes exactly the entities of the snapshot alive again, with their saved ids. Entities created
+	// after the snapshot was taken are released, so handles to them don't match any restored entity.
+	// A restored entity may get an older generation back than one handed out since the snapshot,
+	// its next release skips past that one so that such stale handles never match again.
+	void load(SnapshotReader& in)
+	{
+		std::vector<unsigned int> saved_generations, saved_free;
+		in.read_array(saved_generations);
+		in.read_array(saved_free);
+
+		std::vector<bool> alive_now(generations.size(), true), alive_saved(saved_generations.size(), true);
+		for (unsigned int index : free_indices)
+			alive_now[index] = false;
+		for (unsigned int index : saved_free)
+			alive_saved[index] = false;
+
+		generations.resize(std::max(generations.size(), saved_generations.size()), 0);
+		alive_now.resize(generations.size(), false);
+		free_indices.clear();
+		for (unsigned int index = (unsigned int)generations.size() - 1; index > 0; index--)
+		{
+			if (index < alive_saved.size() && alive_saved[index])
+			{
+				// The current generation is the last one handed out, or one past it if released
+				if (generations[index] != saved_generations[index])
+				{
+					if (index >= release_floor.size())
+						release_floor.resize(generations.size(), 0);
+					release_floor[index] = std::max(release_floor[index], generations[index] + 1);
+				}
+				generations[index] = saved_generations[index];
+			}
+			else
+			{
+				if (alive_now[index])
+					generations[index] = (generations[index] + 1) & ENTITY_GENERATION_MASK;
+				free_indices.push_back(index);
+			}
+		}
+	}
+};
+extern EntityManager entity_manager;
+
+// The current frame of the game loop, advanced by the registry. Component changes are stamped
+// with it, see ComponentContainer::patch()
+extern unsigned int current_frame;
+
+inline Entity::Entity()
+{
+	*this = entity_manager.create();
+}
+
+// Bitmask of the component types an entity has, bit i is set for the component with id i
+const size_t MAX_COMPONENT_TYPES = 64;
+typedef std::bitset<MAX_COMPONENT_TYPES> ComponentMask;
+
+// The sparse Entity -> array index table is split into pages of SPARSE_PAGE_SIZE slots that
+// are only allocated once an entity id falling into them is inserted
+const unsigned int SPARSE_PAGE_BITS = 10;
+const unsigned int SPARSE_PAGE_SIZE = 1u << SPARSE_PAGE_BITS;
+const unsigned int SPARSE_INVALID_INDEX = ~0u;
+
+// The paged sparse set from Entity index -> dense array index shared by the containers.
+// A lookup is two array loads instead of a hash.
+class SparseIndex
+{
+	std::vector<std::unique_ptr<unsigned int[]>> pages;
+public:
+	// Returns the slot of the entity, or nullptr if its page was never allocated
+	unsigned int* find(Entity e)
+	{
+		const unsigned int page = e.index() >> SPARSE_PAGE_BITS;
+		if (page >= pages.size() || !pages[page])
+			return nullptr;
+		return &pages[page][e.index() & (SPARSE_PAGE_SIZE - 1)];
+	}
+
+	// Returns the slot of the entity, allocating its page if needed
+	unsigned int& assure(Entity e)
+	{
+		const unsigned int page = e.index() >> SPARSE_PAGE_BITS;
+		if (page >= pages.size())
+			pages.resize(page + 1);
+		if (!pages[page])
+		{
+			pages[page].reset(new unsigned int[SPARSE_PAGE_SIZE]);
+			std::fill_n(pages[page].get(), SPARSE_PAGE_SIZE, SPARSE_INVALID_INDEX);
+		}
+		return pages[page][e.index() & (SPARSE_PAGE_SIZE - 1)];
+	}
+
+	size_t page_count() const
+	{
+		size_t count = 0;
+		for (const auto& page : pages)
+			count += page ? 1 : 0;
+		return count;
+	}
+
+	// Bytes allocated for the page table and the pages
+	size_t memory_bytes() const
+	{
+		return pages.capacity() * sizeof(pages[0]) + page_count() * SPARSE_PAGE_SIZE * sizeof(unsigned int);
+	}
+};
+
+// Memory used by a container, see Registry::memory_report()
+struct ContainerMemory
+{
+	const char* type_name;
+	size_t count;          // live components
+	size_t dense_bytes;    // bytes of the live elements in the dense arrays (components, entities, ...)
+	size_t reserved_bytes; // bytes allocated for the dense arrays, the rest is capacity slack
+	size_t sparse_bytes;   // bytes of the entity -> element lookup (sparse pages or tag bits)
+	size_t sparse_slots;   // slots of the lookup, 'count' of them are in use
+	size_t scratch_bytes = 0; // buffers kept between calls (e.g. the sort permutation), not part of the slack
+
+	size_t total_bytes() const { return reserved_bytes + sparse_bytes + scratch_bytes; }
+
+	// Share of the dense allocation that is unused capacity
+	float slack() const { return reserved_bytes > 0 ? 1.f - (float)dense_bytes / reserved_bytes : 0.f; }
+
+	// Share of the lookup slots in use, the counterpart of the load factor of a hash map
+	float occupancy() const { return sparse_slots > 0 ? (float)count / sparse_slots : 0.f; }
+};
+
+// The link from a container to the per entity component masks of the registry it belongs to (if any)
+struct SignatureHook
+{
+	std::vector<ComponentMask>* signatures = nullptr;
+	size_t component_id = 0;
+
+	void set(Entity e, bool value)
+	{
+		if (signatures == nullptr)
+			return;
+		if (e.index() >= signatures->size())
+			signatures->resize(e.index() + 1);
+		(*signatures)[e.index()].set(component_id, value);
+	}
+};
+
+// Callbacks of an owning group (see Group) into which a container reports its structural changes
+struct GroupHandler
+{
+	virtual ~GroupHandler() = default;
+	virtual void on_insert(Entity e) = 0; // after e was inserted
+	virtual void on_remove(Entity e) = 0; // before e is removed
+	virtual void on_clear() = 0;
+};
+
+// Listeners that are called with the entity whose component was constructed, destroyed or updated,
+// see ComponentContainer::on_construct. A listener is a function pointer plus the instance it was
+// connected with, an unconnected signal costs a single emptiness check.
+class Signal
+{
+	struct Listener
+	{
+		void* instance;
+		void (*call)(void*, Entity);
+	};
+	std::vector<Listener> listeners;
+
+	template <class T, void (T::*Method)(Entity)>
+	static void call_member(void* instance, Entity e)
+	{
+		(static_cast<T*>(instance)->*Method)(e);
+	}
 public:
-	Entity()
+	// Connect a free function, 'instance' is passed back as its first argument
+	void connect(void (*func)(void*, Entity), void* instance = nullptr)
+	{
+		listeners.push_back({ instance, func });
+	}
+
+	// Connect a member function, e.g. registry.on_construct<Minion>().connect<Grid, &Grid::add>(&grid)
+	template <class T, void (T::*Method)(Entity)>
+	void connect(T* instance)
+	{
+		connect(&call_member<T, Method>, instance);
+	}
+
+	// Remove all listeners that were connected with 'instance'
+	void disconnect(void* instance)
+	{
+		listeners.erase(std::remove_if(listeners.begin(), listeners.end(),
+			[instance](const Listener& l) { return l.instance == instance; }), listeners.end());
+	}
+
+	bool empty() const
+	{
+		return listeners.empty();
+	}
+
+	// Indexed loop, a listener may connect or disconnect others while being called
+	void publish(Entity e) const
 	{
-		id = id_count++;
-		// Note, indices of already deleted entities arent re-used in this simple implementation.
+		for (size_t i = 0; i < listeners.size(); i++)
+			listeners[i].call(listeners[i].instance, e);
 	}
-	operator unsigned int() { return id; } // this enables automatic casting to int
 };
 
-// Common interface to refer to all containers in the ECS registry
-struct ContainerInterface
+// An array of fixed size pages. Elements never move when it grows, so references to them stay valid
+// across push_back, unlike with std::vector. They are still invalidated by the removal of that
+// element and by swaps, i.e. by remove() and sort() of a container and by an owning group.
+template <typename T, size_t PageSize = 256>
+class PagedVector
 {
-	virtual void clear() = 0;
-	virtual size_t size() = 0;
-	virtual void remove(Entity e) = 0;
-	virtual bool has(Entity entity) = 0;
+	typedef typename std::aligned_storage<sizeof(T), alignof(T)>::type Slot;
+	std::vector<std::unique_ptr<Slot[]>> pages;
+	size_t count = 0;
+
+	T* slot(size_t i) const
+	{
+		return reinterpret_cast<T*>(&pages[i / PageSize][i % PageSize]);
+	}
+
+	void add_page()
+	{
+		pages.emplace_back(new Slot[PageSize]);
+	}
+
+public:
+	typedef T value_type;
+	typedef T& reference;
+	typedef T* pointer;
+
+	PagedVector() = default;
+	PagedVector(const PagedVector&) = delete;
+	PagedVector& operator=(const PagedVector&) = delete;
+	~PagedVector() { clear(); }
+
+	size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+	size_t capacity() const { return pages.size() * PageSize; }
+
+	T& operator[](size_t i) { return *slot(i); }
+	const T& operator[](size_t i) const { return *slot(i); }
+	T& back() { return *slot(count - 1); }
+
+	void push_back(T&& value)
+	{
+		if (count == capacity())
+			add_page();
+		new (slot(count)) T(std::move(value));
+		count++;
+	}
+	void push_back(const T& value)
+	{
+		T copy(value);
+		push_back(std::move(copy));
+	}
+
+	void pop_back()
+	{
+		slot(--count)->~T();
+	}
+
+	// The pages stay allocated for re-use
+	void clear()
+	{
+		while (count > 0)
+			pop_back();
+	}
+
+	void reserve(size_t size)
+	{
+		while (capacity() < size)
+			add_page();
+	}
+
+	template <typename It>
+	void assign(It first, It last)
+	{
+		clear();
+		for (; first != last; ++first)
+			push_back(*first);
+	}
 };
 
+// The array a container keeps its components in, a std::vector unless specialized for a component
+// type whose references have to stay valid across inserts, e.g.
+// template <> struct component_array<LightSource> { typedef PagedVector<LightSource> type; };
+// or one that is stored as structure of arrays, see MotionSoA.
+template <typename Component>
+struct component_array { typedef std::vector<Component> type; };
+
+// The operations of ComponentContainer on its array beyond push_back/pop_back and operator[].
+// Arrays whose operator[] returns a proxy instead of a reference overload them, see MotionSoA.
+template <typename Array>
+typename Array::pointer array_element(Array& array, size_t i) { return &array[i]; }
+template <typename Array>
+void array_swap(Array& array, size_t i, size_t j) { std::swap(array[i], array[j]); }
+template <typename Array>
+void array_save(SnapshotWriter& out, const Array& array) { out.write_array(array); }
+template <typename Array>
+void array_load(SnapshotReader& in, Array& array) { in.read_array(array); }
+
 // A container that stores components of type 'Component' and associated entities
-template <typename Component> // A component can be any class
-class ComponentContainer : public ContainerInterface
+template <typename Component, typename Array = typename component_array<Component>::type> // A component can be any class
+class ComponentContainer
 {
 private:
-	// The hash map from Entity -> array index.
-	std::unordered_map<unsigned int, unsigned int> map_entity_componentID; // the entity is cast to uint to be hashable.
+	SparseIndex sparse;
 	bool registered = false;
+
+	// Keeps the registry's entity signatures up to date, see attach_signatures
+	SignatureHook signature_hook;
+
+	// The group that owns this container and decides about the order of its elements, if any
+	GroupHandler* owner = nullptr;
+
+	// Scratch buffer of sort(), kept to not allocate on every call
+	std::vector<unsigned int> permutation;
+
+	// Observers of the structural changes and updates, see on_construct
+	Signal construct_signal;
+	Signal destroy_signal;
+	Signal update_signal;
+
+	unsigned int* sparse_slot(Entity e) { return sparse.find(e); }
+
+	void save(SnapshotWriter& out, std::true_type) const
+	{
+		array_save(out, components);
+		out.write_array(entities);
+		out.write_array(enabled);
+	}
+	void save(SnapshotWriter&, std::false_type) const {}
+
+	void load(SnapshotReader& in, std::true_type)
+	{
+		array_load(in, components);
+		in.read_array(entities);
+		in.read_array(enabled);
+	}
+	void load(SnapshotReader&, std::false_type)
+	{
+		components.clear();
+		entities.clear();
+		enabled.clear();
+	}
+	unsigned int& assure_sparse_slot(Entity e) { return sparse.assure(e); }
+
 public:
+	typedef Component value_type;
+
+	// What get() and try_get() return, Component& and Component* unless the array hands out proxies
+	typedef typename Array::reference reference;
+	typedef typename Array::pointer pointer;
+
 	// Container of all components of type 'Component'
-	std::vector<Component> components;
+	Array components;
 
 	// The corresponding entities
 	std::vector<Entity> entities;
 
+	// The frame in which each component was inserted or last patched
+	std::vector<unsigned int> versions;
+
+	// Whether each component is enabled, views, queries and groups skip disabled ones, see disable()
+	std::vector<uint8_t> enabled;
+
 	// Constructor that registers the type
 	ComponentContainer()
 	{
 	}
 
+	// Keep the bit 'id' of the entity signatures up to date on insert and remove
+	void attach_signatures(std::vector<ComponentMask>* table, size_t id)
+	{
+		signature_hook.signatures = table;
+		signature_hook.component_id = id;
+	}
+
 	// Inserting a component c associated to entity e
-	inline Component& insert(Entity e, Component c, bool check_for_duplicates = true)
+	inline reference insert(Entity e, Component c, bool check_for_duplicates = true)
 	{
 		// Usually, every entity should only have one instance of each component type
 		assert(!(check_for_duplicates && has(e)) && "Entity already contained in ECS registry");
 
-		map_entity_componentID[e] = (unsigned int)components.size();
+		assure_sparse_slot(e) = (unsigned int)components.size();
 		components.push_back(std::move(c)); // the move enforces move instead of copy constructor
 		entities.push_back(e);
-		return components.back();
+		versions.push_back(current_frame);
+		enabled.push_back(1);
+		signature_hook.set(e, true);
+		if (owner == nullptr && construct_signal.empty())
+			return components.back();
+
+		if (owner != nullptr)
+			owner->on_insert(e); // may move the new element to the front
+		construct_signal.publish(e);
+		return get(e);
 	};
 
 	// The emplace function takes the the provided arguments Args, creates a new object of type Component, and inserts it into the ECS system
 	template<typename... Args>
-	Component& emplace(Entity e, Args &&... args) {
+	reference emplace(Entity e, Args &&... args) {
 		return insert(e, Component(std::forward<Args>(args)...));
 	};
 	template<typename... Args>
-	Component& emplace_with_duplicates(Entity e, Args &&... args) {
+	reference emplace_with_duplicates(Entity e, Args &&... args) {
 		return insert(e, Component(std::forward<Args>(args)...), false);
 	};
 
 	// A wrapper to return the component of an entity
-	Component& get(Entity e) {
+	reference get(Entity e) {
+		assert(has(e) && "Entity not contained in ECS registry");
+		return components[*sparse_slot(e)];
+	}
+
+	// Mutable access that records the change, use it for all writes that others may want to react to
+	reference patch(Entity e) {
+		assert(has(e) && "Entity not contained in ECS registry");
+		const unsigned int i = *sparse_slot(e);
+		versions[i] = current_frame;
+		return components[i];
+	}
+
+	// Applies func(Component&) and records the change, then publishes on_update. Use this form
+	// when observers need to see the new value, patch(e) can't publish as the write comes after it.
+	template <typename Func>
+	reference patch(Entity e, Func func)
+	{
+		reference c = patch(e);
+		func(c);
+		if (!update_signal.empty())
+			update_signal.publish(e);
+		return c;
+	}
+
+	// Signals published after a component was inserted, before one is removed (also by clear())
+	// and after patch(e, func). Listeners get the entity and may look the component up with get().
+	// Listeners of on_destroy must not insert or remove components of this container.
+	Signal& on_construct() { return construct_signal; }
+	Signal& on_destroy() { return destroy_signal; }
+	Signal& on_update() { return update_signal; }
+
+	// The frame in which the component of the entity was inserted or last patched
+	unsigned int version(Entity e) {
 		assert(has(e) && "Entity not contained in ECS registry");
-		return components[map_entity_componentID[e]];
+		return versions[*sparse_slot(e)];
+	}
+
+	// Check whether the component of the entity was inserted or patched after 'frame'
+	bool changed_since(Entity e, unsigned int frame) {
+		return version(e) > frame;
+	}
+
+	// Calls func(Entity, Component&) for the enabled components inserted or patched after 'frame'
+	template <typename Func>
+	void each_changed_since(unsigned int frame, Func func) {
+		for (unsigned int i = 0; i < versions.size(); i++)
+			if (versions[i] > frame && enabled[i])
+				func(entities[i], components[i]);
+	}
+
+	// Toggle a component without a structural change, O(1) and the dense arrays don't move. A disabled
+	// component is still there for has() and get(), only views, queries and groups skip its entity.
+	void enable(Entity e) {
+		enabled[index_of(e)] = 1;
+	}
+	void disable(Entity e) {
+		enabled[index_of(e)] = 0;
+	}
+	bool is_enabled(Entity e) {
+		return enabled[index_of(e)] != 0;
+	}
+
+	// Returns the component of an entity or nullptr if it has none or it is disabled, with a single lookup
+	pointer try_get_enabled(Entity e) {
+		const unsigned int* slot = sparse_slot(e);
+		if (slot == nullptr || *slot == SPARSE_INVALID_INDEX || entities[*slot] != e || !enabled[*slot])
+			return nullptr;
+		return array_element(components, *slot);
+	}
+
+	// Returns the component of an entity or nullptr if it has none, with a single lookup
+	pointer try_get(Entity e) {
+		const unsigned int* slot = sparse_slot(e);
+		if (slot == nullptr || *slot == SPARSE_INVALID_INDEX || entities[*slot] != e)
+			return nullptr;
+		return array_element(components, *slot);
 	}
 
-	// Check if entity has a component of type 'Component'
+	// Check if entity has a component of type 'Component', stale handles of a re-used index don't match
 	bool has(Entity entity) {
-		return map_entity_componentID.count(entity) > 0;
+		const unsigned int* slot = sparse_slot(entity);
+		return slot != nullptr && *slot != SPARSE_INVALID_INDEX && entities[*slot] == entity;
 	}
 
 	// Remove an component and pack the container to re-use the empty space
@@ -89,29 +692,54 @@ public:
 	{
 		if (has(e))
 		{
+			if (!destroy_signal.empty())
+				destroy_signal.publish(e);
+
+			// Let the owning group move the element out of its range first
+			if (owner != nullptr)
+				owner->on_remove(e);
+
 			// Get the current position
-			int cID = map_entity_componentID[e];
+			unsigned int& slot = *sparse_slot(e);
+			unsigned int cID = slot;
 
 			// Move the last element to position cID using the move operator
 			// Note, components[cID] = components.back() would trigger the copy instead of move operator
 			components[cID] = std::move(components.back());
 			entities[cID] = entities.back(); // the entity is only a single index, copy it.
-			map_entity_componentID[entities.back()] = cID;
+			versions[cID] = versions.back();
+			enabled[cID] = enabled.back();
+			*sparse_slot(entities.back()) = cID;
 
 			// Erase the old component and free its memory
-			map_entity_componentID.erase(e);
+			slot = SPARSE_INVALID_INDEX;
+			signature_hook.set(e, false);
 			components.pop_back();
 			entities.pop_back();
-			// Note, one could mark the id for re-use
+			versions.pop_back();
+			enabled.pop_back();
 		}
 	};
 
 	// Remove all components of type 'Component'
 	void clear()
 	{
-		map_entity_componentID.clear();
+		if (!destroy_signal.empty())
+			for (Entity e : entities)
+				destroy_signal.publish(e);
+
+		// Only reset the used slots, the pages stay allocated for re-use
+		for (Entity e : entities)
+		{
+			*sparse_slot(e) = SPARSE_INVALID_INDEX;
+			signature_hook.set(e, false);
+		}
 		components.clear();
 		entities.clear();
+		versions.clear();
+		enabled.clear();
+		if (owner != nullptr)
+			owner->on_clear();
 	}
 
 	// Report the number of components of type 'Component'
@@ -120,18 +748,1032 @@ public:
 		return components.size();
 	}
 
-	// Sort the components and associated entity assignment structures by the comparisonFunction, see std::sort
+	ContainerMemory memory_usage() const
+	{
+		const size_t element_bytes = sizeof(Component) + sizeof(Entity) + sizeof(unsigned int) + sizeof(uint8_t);
+		ContainerMemory memory;
+		memory.type_name = typeid(Component).name();
+		memory.count = components.size();
+		memory.dense_bytes = components.size() * element_bytes;
+		memory.reserved_bytes = components.capacity() * sizeof(Component) + entities.capacity() * sizeof(Entity)
+			+ versions.capacity() * sizeof(unsigned int) + enabled.capacity() * sizeof(uint8_t);
+		memory.scratch_bytes = permutation.capacity() * sizeof(unsigned int);
+		memory.sparse_bytes = sparse.memory_bytes();
+		memory.sparse_slots = sparse.page_count() * SPARSE_PAGE_SIZE;
+		return memory;
+	}
+
+	// Make room for 'capacity' components, so that inserts up to that size don't reallocate
+	void reserve(size_t capacity)
+	{
+		components.reserve(capacity);
+		entities.reserve(capacity);
+		versions.reserve(capacity);
+		enabled.reserve(capacity);
+	}
+
+	// The array index of the component of an entity
+	unsigned int index_of(Entity e)
+	{
+		assert(has(e) && "Entity not contained in ECS registry");
+		return *sparse_slot(e);
+	}
+
+	// Swap two elements of the dense arrays
+	void swap_elements(unsigned int i, unsigned int j)
+	{
+		if (i == j)
+			return;
+		array_swap(components, i, j);
+		std::swap(entities[i], entities[j]);
+		std::swap(versions[i], versions[j]);
+		std::swap(enabled[i], enabled[j]);
+		*sparse_slot(entities[i]) = i;
+		*sparse_slot(entities[j]) = j;
+	}
+
+	// Append the components to a snapshot, see Registry::snapshot(). Containers of types that are
+	// not trivially copyable are not part of snapshots.
+	void save(SnapshotWriter& out) const
+	{
+		save(out, std::is_trivially_copyable<Component>());
+	}
+
+	// Replace the contents by those of a snapshot, without publishing signals or notifying the
+	// owning group. All components count as changed in the current frame.
+	void load(SnapshotReader& in)
+	{
+		for (Entity e : entities)
+			*sparse_slot(e) = SPARSE_INVALID_INDEX;
+		load(in, std::is_trivially_copyable<Component>());
+		versions.assign(components.size(), current_frame);
+		for (unsigned int i = 0; i < entities.size(); i++)
+		{
+			assure_sparse_slot(entities[i]) = i;
+			signature_hook.set(entities[i], true);
+		}
+	}
+
+	// Hand the order of the elements over to an owning group, a container can only have one owner
+	void set_owner(GroupHandler* group)
+	{
+		assert((owner == nullptr || group == nullptr) && "Container is already owned by a group");
+		owner = group;
+	}
+
+	// Sort the components and associated entity assignment structures by the comparisonFunction, see std::sort.
+	// The permutation is computed once and applied in place by following its cycles, the scratch
+	// buffer is kept between calls so that sorting every frame does not allocate.
 	template <class Compare>
 	void sort(Compare comparisonFunction)
 	{
-		// First sort the entity list as desired
-		std::sort(entities.begin(), entities.end(), comparisonFunction);
-		// Now re-arrange the components (Note, creates a new vector, which may be slow! Not sure if in-place could be faster: https://stackoverflow.com/questions/63703637/how-to-efficiently-permute-an-array-in-place-using-stdswap)
-		std::vector<Component> components_new; components_new.reserve(components.size());
-		std::transform(entities.begin(), entities.end(), std::back_inserter(components_new), [&](Entity e) { return std::move(get(e)); }); // note, the get still uses the old hash map (on purpose!)
-		components = std::move(components_new); // note, we use move operations to not create unneccesary copies of objects, but memory is still allocated for the new vector
-		// Fill the new hashmap
-		for (unsigned int i = 0; i < entities.size(); i++)
-			map_entity_componentID[entities[i]] = i;
+		assert(owner == nullptr && "The order of an owned container is defined by its group");
+		// First sort the array indices by the entities they hold
+		permutation.resize(entities.size());
+		for (unsigned int i = 0; i < permutation.size(); i++)
+			permutation[i] = i;
+		std::sort(permutation.begin(), permutation.end(), [&](unsigned int a, unsigned int b) { return comparisonFunction(entities[a], entities[b]); });
+		apply_permutation();
+	}
+
+	// Move element order[i] to position i for all i < order.size(), the elements behind stay in
+	// place. Used by groups to apply one order to all their containers.
+	void permute(const std::vector<unsigned int>& order)
+	{
+		permutation.assign(order.begin(), order.end());
+		apply_permutation();
+	}
+
+	// Insertion sort by the comparisonFunction, O(n) for data that is already nearly sorted,
+	// e.g. a depth order that changes little from frame to frame. Never allocates.
+	template <class Compare>
+	void sort_incremental(Compare comparisonFunction)
+	{
+		assert(owner == nullptr && "The order of an owned container is defined by its group");
+		for (unsigned int i = 1; i < entities.size(); i++)
+			for (unsigned int j = i; j > 0 && comparisonFunction(entities[j], entities[j - 1]); j--)
+				swap_elements(j, j - 1);
+	}
+
+private:
+	// Element permutation[i] has to move to position i, walk every cycle of the permutation once
+	void apply_permutation()
+	{
+		for (unsigned int i = 0; i < permutation.size(); i++)
+		{
+			unsigned int current = i;
+			while (permutation[current] != i)
+			{
+				const unsigned int next = permutation[current];
+				array_swap(components, current, next);
+				std::swap(entities[current], entities[next]);
+				std::swap(versions[current], versions[next]);
+				std::swap(enabled[current], enabled[next]);
+				permutation[current] = current; // mark as placed
+				current = next;
+			}
+			permutation[current] = current;
+		}
+
+		// Fill the new sparse set
+		for (unsigned int i = 0; i < permutation.size(); i++)
+			*sparse_slot(entities[i]) = i;
+	}
+};
+
+// A container for tag components, i.e., empty structs that only mark an entity (Minion, Background, ...).
+// No component values are stored, just a bitset over the entity indices for membership tests and a
+// packed entity list for iteration. It offers the same interface as ComponentContainer.
+template <typename Tag>
+class TagContainer
+{
+	static_assert(std::is_empty<Tag>::value, "Only empty structs can be stored as tags");
+
+	// One bit per entity index, set if the entity has the tag
+	std::vector<uint64_t> bits;
+	// Entity index -> position in 'entities', only valid where the bit is set
+	std::vector<unsigned int> positions;
+	// All tags are the same, get() returns a reference to this instance
+	Tag instance;
+
+	// Keeps the registry's entity signatures up to date, see ComponentContainer::attach_signatures
+	SignatureHook signature_hook;
+
+	// Tags can't be updated, only constructed and destroyed
+	Signal construct_signal;
+	Signal destroy_signal;
+
+	bool test_bit(unsigned int index) const
+	{
+		return (index >> 6) < bits.size() && (bits[index >> 6] >> (index & 63) & 1u);
+	}
+
+	void set_bit(Entity e, bool value)
+	{
+		const unsigned int index = e.index();
+		if ((index >> 6) >= bits.size())
+			bits.resize((index >> 6) + 1, 0);
+		if (value)
+			bits[index >> 6] |= uint64_t(1) << (index & 63);
+		else
+			bits[index >> 6] &= ~(uint64_t(1) << (index & 63));
+		signature_hook.set(e, value);
+	}
+
+public:
+	typedef Tag value_type;
+	typedef Tag& reference;
+	typedef Tag* pointer;
+
+	// The entities that have the tag
+	std::vector<Entity> entities;
+
+	void attach_signatures(std::vector<ComponentMask>* table, size_t id)
+	{
+		signature_hook.signatures = table;
+		signature_hook.component_id = id;
+	}
+
+	Tag& insert(Entity e, Tag = Tag(), bool check_for_duplicates = true)
+	{
+		assert(!(check_for_duplicates && has(e)) && "Entity already contained in ECS registry");
+		if (has(e))
+			return instance;
+		if (e.index() >= positions.size())
+			positions.resize(e.index() + 1);
+		positions[e.index()] = (unsigned int)entities.size();
+		entities.push_back(e);
+		set_bit(e, true);
+		if (!construct_signal.empty())
+			construct_signal.publish(e);
+		return instance;
+	}
+
+	template<typename... Args>
+	Tag& emplace(Entity e, Args &&...) {
+		return insert(e);
+	};
+
+	Tag& get(Entity e) {
+		assert(has(e) && "Entity not contained in ECS registry");
+		return instance;
+	}
+
+	Tag* try_get(Entity e) {
+		return has(e) ? &instance : nullptr;
+	}
+
+	// Tags can't be disabled, removing one is already O(1) and moves no component data
+	bool is_enabled(Entity) {
+		return true;
+	}
+	Tag* try_get_enabled(Entity e) {
+		return try_get(e);
+	}
+
+	// A bit test, plus a comparison of the full id to not match stale handles of a re-used index
+	bool has(Entity e) {
+		return test_bit(e.index()) && entities[positions[e.index()]] == e;
+	}
+
+	void remove(Entity e)
+	{
+		if (has(e))
+		{
+			if (!destroy_signal.empty())
+				destroy_signal.publish(e);
+			const unsigned int position = positions[e.index()];
+			entities[position] = entities.back();
+			positions[entities.back().index()] = position;
+			entities.pop_back();
+			set_bit(e, false);
+		}
+	}
+
+	void clear()
+	{
+		for (Entity e : entities)
+		{
+			if (!destroy_signal.empty())
+				destroy_signal.publish(e);
+			set_bit(e, false);
+		}
+		entities.clear();
+	}
+
+	Signal& on_construct() { return construct_signal; }
+	Signal& on_destroy() { return destroy_signal; }
+
+	void save(SnapshotWriter& out) const
+	{
+		out.write_array(entities);
+	}
+
+	void load(SnapshotReader& in)
+	{
+		std::fill(bits.begin(), bits.end(), 0);
+		in.read_array(entities);
+		for (unsigned int i = 0; i < entities.size(); i++)
+		{
+			if (entities[i].index() >= positions.size())
+				positions.resize(entities[i].index() + 1);
+			positions[entities[i].index()] = i;
+			set_bit(entities[i], true);
+		}
+	}
+
+	size_t size()
+	{
+		return entities.size();
+	}
+
+	void reserve(size_t capacity)
+	{
+		entities.reserve(capacity);
+	}
+
+	ContainerMemory memory_usage() const
+	{
+		ContainerMemory memory;
+		memory.type_name = typeid(Tag).name();
+		memory.count = entities.size();
+		memory.dense_bytes = entities.size() * sizeof(Entity);
+		memory.reserved_bytes = entities.capacity() * sizeof(Entity);
+		memory.sparse_bytes = bits.capacity() * sizeof(uint64_t) + positions.capacity() * sizeof(unsigned int);
+		memory.sparse_slots = positions.size();
+		return memory;
+	}
+};
+
+// An owning group keeps the entities that have all 'Owned' components packed at the front of
+// every owned container, in the same order. Element i < size() of all owned containers then
+// belongs to the same entity and the group can be iterated as parallel arrays, without lookups.
+// The group is maintained on every insert/remove of the owned containers.
+template <typename... Owned>
+class Group : public GroupHandler
+{
+	std::tuple<ComponentContainer<Owned>*...> containers;
+	size_t group_size = 0;
+
+	// Scratch of sort(), kept between calls
+	std::vector<unsigned int> order;
+
+	// The first owned container, its entities in [0, group_size) are the group members
+	ComponentContainer<typename std::tuple_element<0, std::tuple<Owned...>>::type>& front()
+	{
+		return *std::get<0>(containers);
+	}
+
+	bool has_all(Entity e)
+	{
+		bool has_all = true;
+		(void)std::initializer_list<int>{ (has_all = has_all && std::get<ComponentContainer<Owned>*>(containers)->has(e), 0)... };
+		return has_all;
+	}
+
+	bool in_group(Entity e)
+	{
+		return has_all(e) && front().index_of(e) < group_size;
+	}
+
+	// Move the elements of e in all owned containers to 'position'
+	void swap_to(Entity e, size_t position)
+	{
+		(void)std::initializer_list<int>{ (std::get<ComponentContainer<Owned>*>(containers)->swap_elements(
+			std::get<ComponentContainer<Owned>*>(containers)->index_of(e), (unsigned int)position), 0)... };
+	}
+
+	void swap_members(size_t i, size_t j)
+	{
+		(void)std::initializer_list<int>{ (std::get<ComponentContainer<Owned>*>(containers)->swap_elements((unsigned int)i, (unsigned int)j), 0)... };
+	}
+
+	template <typename Func, size_t... I>
+	void each_impl(Func& func, std::index_sequence<I...>)
+	{
+		for (size_t i = 0; i < group_size; i++)
+		{
+			bool enabled = true;
+			(void)std::initializer_list<int>{ (enabled = enabled && std::get<I>(containers)->enabled[i], 0)... };
+			if (enabled)
+				func(front().entities[i], std::get<I>(containers)->components[i]...);
+		}
+	}
+
+public:
+	Group(ComponentContainer<Owned>&... owned)
+		: containers(&owned...)
+	{
+		(void)std::initializer_list<int>{ (owned.set_owner(this), 0)... };
+		rebuild();
+	}
+
+	~Group()
+	{
+		(void)std::initializer_list<int>{ (std::get<ComponentContainer<Owned>*>(containers)->set_owner(nullptr), 0)... };
+	}
+
+	Group(const Group&) = delete;
+	Group& operator=(const Group&) = delete;
+
+	// Re-collect all members, e.g. after the owned containers were filled without notifying the group
+	void rebuild()
+	{
+		group_size = 0;
+		for (size_t i = 0; i < front().entities.size(); i++)
+		{
+			Entity e = front().entities[i];
+			if (has_all(e))
+				swap_to(e, group_size++);
+		}
+	}
+
+	void on_insert(Entity e) override
+	{
+		if (has_all(e) && !in_group(e))
+			swap_to(e, group_size++);
+	}
+
+	void on_remove(Entity e) override
+	{
+		if (in_group(e))
+			swap_to(e, --group_size);
+	}
+
+	void on_clear() override
+	{
+		group_size = 0;
+	}
+
+	size_t size() const
+	{
+		return group_size;
+	}
+
+	// The members of the group, element i of each owned container belongs to entity(i)
+	Entity entity(size_t i)
+	{
+		return front().entities[i];
+	}
+
+	template <typename C>
+	typename ComponentContainer<C>::reference get(size_t i)
+	{
+		return std::get<ComponentContainer<C>*>(containers)->components[i];
+	}
+
+	// Sort the members by the comparisonFunction on entities, see ComponentContainer::sort. The
+	// order is computed once and applied to every owned container.
+	template <class Compare>
+	void sort(Compare comparisonFunction)
+	{
+		order.resize(group_size);
+		for (unsigned int i = 0; i < order.size(); i++)
+			order[i] = i;
+		std::sort(order.begin(), order.end(), [&](unsigned int a, unsigned int b) { return comparisonFunction(entity(a), entity(b)); });
+		(void)std::initializer_list<int>{ (std::get<ComponentContainer<Owned>*>(containers)->permute(order), 0)... };
+	}
+
+	// Insertion sort of the members, see ComponentContainer::sort_incremental
+	template <class Compare>
+	void sort_incremental(Compare comparisonFunction)
+	{
+		for (size_t i = 1; i < group_size; i++)
+			for (size_t j = i; j > 0 && comparisonFunction(entity(j), entity(j - 1)); j--)
+				swap_members(j, j - 1);
+	}
+
+	// Calls func(Entity, Owned&...) for all members by walking the dense arrays in lockstep, members
+	// with a disabled component are skipped
+	// Note, components must not be added or removed while iterating a group.
+	template <typename Func>
+	void each(Func func)
+	{
+		each_impl(func, std::index_sequence_for<Owned...>());
+	}
+};
+
+// The container type a component is stored in, empty structs are stored as tags
+template <typename Component, bool is_tag = std::is_empty<Component>::value>
+struct component_storage { typedef ComponentContainer<Component> type; };
+template <typename Component>
+struct component_storage<Component, true> { typedef TagContainer<Component> type; };
+template <typename Component>
+using storage_t = typename component_storage<Component>::type;
+
+// Marker for the components that a view filters out, e.g. registry.view<Motion>(exclude<Player>)
+template <typename... Component>
+struct Exclude {};
+template <typename... Component>
+constexpr Exclude<Component...> exclude{};
+
+// A join over several component containers, returning the entities that have all 'Component's
+// enabled and none of the 'Excluded' ones (disabled or not). The join is driven by the entity list of the smallest
+// container, unless another one is picked with use<C>() (e.g. to keep its order).
+// Note, components must not be added or removed while iterating a view.
+template <typename Include, typename Excluded>
+class View;
+
+template <typename... Component, typename... Excluded>
+class View<std::tuple<Component...>, std::tuple<Excluded...>>
+{
+	std::tuple<storage_t<Component>*...> containers;
+	std::tuple<storage_t<Excluded>*...> excluded;
+	const std::vector<Entity>* pivot;
+
+	bool has_none_excluded(Entity e) const
+	{
+		(void)e; // unused when nothing is excluded
+		bool has_any = false;
+		(void)std::initializer_list<int>{ (has_any = has_any || std::get<storage_t<Excluded>*>(excluded)->has(e), 0)... };
+		return !has_any;
+	}
+
+	template <typename Func, size_t... I>
+	void apply(Func& func, Entity e, std::tuple<typename storage_t<Component>::pointer...>& found, std::index_sequence<I...>)
+	{
+		func(e, *std::get<I>(found)...);
+	}
+
+public:
+	View(storage_t<Component>&... include, storage_t<Excluded>&... exclude)
+		: containers(&include...), excluded(&exclude...)
+	{
+		const std::array<const std::vector<Entity>*, sizeof...(Component)> candidates = { &include.entities... };
+		pivot = *std::min_element(candidates.begin(), candidates.end(),
+			[](const std::vector<Entity>* a, const std::vector<Entity>* b) { return a->size() < b->size(); });
+	}
+
+	// Drive the iteration by the entities of container C, preserving their order
+	template <typename C>
+	View& use()
+	{
+		pivot = &std::get<storage_t<C>*>(containers)->entities;
+		return *this;
+	}
+
+	// Check whether an entity is part of the view
+	bool contains(Entity e) const
+	{
+		bool has_all = true;
+		(void)std::initializer_list<int>{ (has_all = has_all && std::get<storage_t<Component>*>(containers)->try_get_enabled(e) != nullptr, 0)... };
+		return has_all && has_none_excluded(e);
+	}
+
+	// Access a component of an entity in the view
+	template <typename C>
+	typename storage_t<C>::reference get(Entity e)
+	{
+		return std::get<storage_t<C>*>(containers)->get(e);
+	}
+
+	// Calls func(Entity, Component&...) for every entity in the view
+	template <typename Func>
+	void each(Func func)
+	{
+		for (Entity e : *pivot)
+		{
+			std::tuple<typename storage_t<Component>::pointer...> found(std::get<storage_t<Component>*>(containers)->try_get_enabled(e)...);
+			bool has_all = true;
+			(void)std::initializer_list<int>{ (has_all = has_all && std::get<typename storage_t<Component>::pointer>(found) != nullptr, 0)... };
+			if (has_all && has_none_excluded(e))
+				apply(func, e, found, std::index_sequence_for<Component...>());
+		}
+	}
+
+	// Iterates the entities in the view, for use in range based for loops
+	class iterator
+	{
+		const View* view;
+		std::vector<Entity>::const_iterator it, last;
+		void skip() { while (it != last && !view->contains(*it)) ++it; }
+	public:
+		iterator(const View* view, std::vector<Entity>::const_iterator it, std::vector<Entity>::const_iterator last)
+			: view(view), it(it), last(last) { skip(); }
+		Entity operator*() const { return *it; }
+		iterator& operator++() { ++it; skip(); return *this; }
+		bool operator!=(const iterator& other) const { return it != other.it; }
+	};
+	iterator begin() const { return iterator(this, pivot->begin(), pivot->end()); }
+	iterator end() const { return iterator(this, pivot->end(), pivot->end()); }
+};
+
+// The entities matching an include/exclude component mask, kept up to date through the container
+// signals instead of being searched for on every query, see Registry::query
+class QueryCache
+{
+	SparseIndex sparse; // Entity index -> position in 'entities'
+	const std::vector<ComponentMask>* signatures;
+
+public:
+	const ComponentMask include;
+	const ComponentMask exclude;
+
+	// The matching entities, in the order they started to match
+	std::vector<Entity> entities;
+
+	QueryCache(const std::vector<ComponentMask>* signatures, ComponentMask include, ComponentMask exclude)
+		: signatures(signatures), include(include), exclude(exclude) {}
+
+	bool contains(Entity e)
+	{
+		const unsigned int* slot = sparse.find(e);
+		return slot != nullptr && *slot != SPARSE_INVALID_INDEX && entities[*slot] == e;
+	}
+
+	// Add or remove the entity depending on whether 'signature' matches
+	void update(Entity e, ComponentMask signature)
+	{
+		const bool matches = (signature & include) == include && (signature & exclude).none();
+		if (matches == contains(e))
+			return;
+		if (matches)
+		{
+			sparse.assure(e) = (unsigned int)entities.size();
+			entities.push_back(e);
+		}
+		else
+		{
+			unsigned int& slot = *sparse.find(e);
+			entities[slot] = entities.back();
+			*sparse.find(entities.back()) = slot;
+			slot = SPARSE_INVALID_INDEX;
+			entities.pop_back();
+		}
+	}
+
+	size_t memory_bytes() const
+	{
+		return entities.capacity() * sizeof(Entity) + sparse.memory_bytes();
+	}
+
+	// Drop all entities, e.g. before re-collecting them with update()
+	void clear()
+	{
+		for (Entity e : entities)
+			*sparse.find(e) = SPARSE_INVALID_INDEX;
+		entities.clear();
+	}
+
+	// Signal listeners, the signature already has the bit set on construct but still has it on destroy
+	static void on_construct(void* cache, Entity e)
+	{
+		QueryCache* query = static_cast<QueryCache*>(cache);
+		query->update(e, (*query->signatures)[e.index()]);
+	}
+	template <size_t Id>
+	static void on_destroy(void* cache, Entity e)
+	{
+		QueryCache* query = static_cast<QueryCache*>(cache);
+		query->update(e, ComponentMask((*query->signatures)[e.index()]).reset(Id));
+	}
+};
+
+// The components of the entities of a QueryCache, iterating it is a walk over the cached entity
+// list. The cache follows structural changes only, entities with a disabled component are skipped
+// while iterating. As with View, components must not be added or removed while iterating.
+template <typename... Component>
+class Query
+{
+	const QueryCache* cache;
+	std::tuple<storage_t<Component>*...> containers;
+
+	template <typename Func, size_t... I>
+	void apply(Func& func, Entity e, std::tuple<typename storage_t<Component>::pointer...>& found, std::index_sequence<I...>)
+	{
+		func(e, *std::get<I>(found)...);
+	}
+
+public:
+	Query(const QueryCache* cache, storage_t<Component>&... include)
+		: cache(cache), containers(&include...) {}
+
+	// Calls func(Entity, Component&...) for every entity matching the query
+	template <typename Func>
+	void each(Func func)
+	{
+		for (Entity e : cache->entities)
+		{
+			std::tuple<typename storage_t<Component>::pointer...> found(std::get<storage_t<Component>*>(containers)->try_get_enabled(e)...);
+			bool has_all = true;
+			(void)std::initializer_list<int>{ (has_all = has_all && std::get<typename storage_t<Component>::pointer>(found) != nullptr, 0)... };
+			if (has_all)
+				apply(func, e, found, std::index_sequence_for<Component...>());
+		}
+	}
+
+	// The cached entities, including those with disabled components
+	size_t size() const { return cache->entities.size(); }
+	std::vector<Entity>::const_iterator begin() const { return cache->entities.begin(); }
+	std::vector<Entity>::const_iterator end() const { return cache->entities.end(); }
+};
+
+// Compile time index of the type T in the type list Ts..., used as component id
+template <typename T, typename... Ts>
+struct type_index;
+template <typename T, typename... Ts>
+struct type_index<T, T, Ts...> : std::integral_constant<size_t, 0> {};
+template <typename T, typename U, typename... Ts>
+struct type_index<T, U, Ts...> : std::integral_constant<size_t, 1 + type_index<T, Ts...>::value> {};
+
+// Records structural changes (entity creation/destruction, component insertion/removal) while
+// systems iterate over containers and applies them in one batch at a sync point with flush().
+// Commands are applied in the order they were recorded. The component values of insertions are
+// kept in one typed array per component type, nothing is type-erased or allocated per command.
+// Note, not thread safe: create() allocates from the global entity_manager right away.
+template <typename... Components>
+class CommandBuffer
+{
+	enum class Kind : uint8_t { EMPLACE, REMOVE, DESTROY };
+
+	struct Command
+	{
+		Kind kind;
+		uint8_t component_id;
+		unsigned int value; // EMPLACE: index into the array of pending values of the component
+		Entity entity;
+	};
+
+	std::vector<Command> commands;
+	std::tuple<std::vector<Components>...> values;
+
+	template <typename Component>
+	static constexpr uint8_t id_of() { return (uint8_t)type_index<Component, Components...>::value; }
+
+	// Inserts a pending value, indexed by component id
+	template <typename RegistryType, typename Component>
+	static void apply_emplace(CommandBuffer& buffer, RegistryType& registry, const Command& command)
+	{
+		// Moved out first, a listener recording more commands may reallocate the array
+		Component value = std::move(std::get<std::vector<Component>>(buffer.values)[command.value]);
+		registry.template storage<Component>().insert(command.entity, std::move(value));
+	}
+
+public:
+	// Entity ids are handed out right away, they only get components once flushed
+	Entity create() { return Entity(); }
+
+	// Destroy the entity with all its components on the next flush
+	void destroy(Entity e) { commands.push_back({ Kind::DESTROY, 0, 0, e }); }
+
+	// Insert a component of type 'Component' constructed from args on the next flush
+	template <typename Component, typename... Args>
+	void emplace(Entity e, Args&&... args)
+	{
+		std::vector<Component>& pending = std::get<std::vector<Component>>(values);
+		commands.push_back({ Kind::EMPLACE, id_of<Component>(), (unsigned int)pending.size(), e });
+		pending.emplace_back(std::forward<Args>(args)...);
+	}
+
+	// Remove the component of type 'Component' on the next flush
+	template <typename Component>
+	void remove(Entity e) { commands.push_back({ Kind::REMOVE, id_of<Component>(), 0, e }); }
+
+	bool empty() const { return commands.empty(); }
+
+	// Apply all recorded changes to the registry in order, commands targeting entities that were
+	// destroyed in the meantime are skipped. Commands recorded while flushing (e.g. by an
+	// on_destroy listener) are applied after the ones recorded before. The buffers keep their
+	// memory for the next frame.
+	template <typename RegistryType>
+	void flush(RegistryType& registry)
+	{
+		typedef void (*Emplacer)(CommandBuffer&, RegistryType&, const Command&);
+		static const std::array<Emplacer, sizeof...(Components)> emplacers = { { &apply_emplace<RegistryType, Components>... } };
+
+		// Note, indexed loop and copies as the commands may record further commands
+		for (size_t i = 0; i < commands.size(); i++)
+		{
+			const Command command = commands[i];
+			if (!entity_manager.alive(command.entity))
+				continue;
+			switch (command.kind)
+			{
+			case Kind::EMPLACE: emplacers[command.component_id](*this, registry, command); break;
+			case Kind::REMOVE: registry.remove_component(command.component_id, command.entity); break;
+			case Kind::DESTROY: registry.remove_all_components_of(command.entity); break;
+			}
+		}
+		commands.clear();
+		(void)std::initializer_list<int>{ (std::get<std::vector<Components>>(values).clear(), 0)... };
+	}
+};
+
+// Memory used by a registry, per container and in total
+struct MemoryReport
+{
+	std::vector<ContainerMemory> containers;
+	size_t live_entities = 0;
+	size_t entity_capacity = 0;  // entity indices handed out so far
+	size_t entity_bytes = 0;     // entity manager tables
+	size_t signature_bytes = 0;  // per entity component masks
+	size_t query_bytes = 0;      // cached query entity lists and lookups
+
+	size_t total_bytes() const
+	{
+		size_t total = entity_bytes + signature_bytes + query_bytes;
+		for (const ContainerMemory& container : containers)
+			total += container.total_bytes();
+		return total;
+	}
+
+	float bytes_per_entity() const
+	{
+		return live_entities > 0 ? (float)total_bytes() / live_entities : 0.f;
+	}
+
+	void print() const
+	{
+		printf("ECS memory: %zu live entities (%zu indices), %.1f KB, %.1f bytes per live entity\n",
+			live_entities, entity_capacity, total_bytes() / 1024.f, bytes_per_entity());
+		printf("  entities %.1f KB, signatures %.1f KB, queries %.1f KB\n",
+			entity_bytes / 1024.f, signature_bytes / 1024.f, query_bytes / 1024.f);
+		printf("  %6s %10s %10s %6s %10s %9s %10s  %s\n", "count", "dense KB", "alloc KB", "slack", "sparse KB", "occupancy", "scratch KB", "type");
+		for (const ContainerMemory& c : containers)
+			printf("  %6zu %10.1f %10.1f %5.0f%% %10.1f %8.1f%% %10.1f  %s\n", c.count, c.dense_bytes / 1024.f, c.reserved_bytes / 1024.f,
+				c.slack() * 100.f, c.sparse_bytes / 1024.f, c.occupancy() * 100.f, c.scratch_bytes / 1024.f, c.type_name);
+	}
+};
+
+// A registry with one container per type in the 'Components' list. All operations that touch
+// every container are expanded at compile time over that list, so none can be forgotten.
+template <typename... Components>
+class Registry
+{
+	static_assert(sizeof...(Components) <= MAX_COMPONENT_TYPES, "Too many component types for ComponentMask");
+
+	std::tuple<storage_t<Components>...> containers;
+
+	// The component mask of every entity, indexed by Entity::index()
+	std::vector<ComponentMask> signatures;
+
+	// The entity lists of all queries made so far, see query()
+	std::vector<std::unique_ptr<QueryCache>> queries;
+
+	// Removes the component with id i from an entity, indexed by component id
+	typedef void (*Remover)(Registry&, Entity);
+	template <typename Component>
+	static void remove_component(Registry& registry, Entity e) { registry.storage<Component>().remove(e); }
+	const std::array<Remover, sizeof...(Components)> removers = { { &remove_component<Components>... } };
+
+	template <typename Container, typename Component>
+	static void insert_copies(Container& container, const std::vector<Entity>& entities, size_t first, const Component& prototype)
+	{
+		for (size_t i = first; i < entities.size(); i++)
+			container.insert(entities[i], prototype);
+	}
+
+	// Calls func(container) on every container, in the order of the type list
+	template <typename Func>
+	void for_each_container(Func func)
+	{
+		(void)std::initializer_list<int>{ (func(std::get<storage_t<Components>>(containers)), 0)... };
+	}
+
+public:
+	static constexpr size_t component_count = sizeof...(Components);
+
+	// Structural changes deferred to the next flush_commands(), use while iterating containers
+	CommandBuffer<Components...> commands;
+
+	Registry()
+	{
+		for_each_container([this](auto& container) {
+			container.attach_signatures(&signatures, component_id<typename std::decay_t<decltype(container)>::value_type>());
+		});
+	}
+
+	// Compile time id of a component type, its index in the type list
+	template <typename Component>
+	static constexpr size_t component_id() { return type_index<Component, Components...>::value; }
+
+	// Returns the container of components of type 'Component'
+	template <typename Component>
+	storage_t<Component>& storage()
+	{
+		return std::get<storage_t<Component>>(containers);
+	}
+
+	// Make room for 'count' more entities with the given component types
+	template <typename... Component>
+	void reserve(size_t count)
+	{
+		(void)std::initializer_list<int>{ (storage<Component>().reserve(storage<Component>().size() + count), 0)... };
+		signatures.reserve(entity_manager.capacity() + count);
+	}
+
+	// Create 'count' entities that each get a copy of 'prototypes', e.g. a wave of minions. The
+	// capacity is reserved once and each container is filled in one pass. The new entities are
+	// appended to 'out', so that the caller can adjust them afterwards (e.g. their positions).
+	// registry.spawn(10, out, Motion(), Minion(), &mesh);
+	template <typename... Component>
+	void spawn(size_t count, std::vector<Entity>& out, const Component&... prototypes)
+	{
+		reserve<Component...>(count);
+		const size_t first = out.size();
+		entity_manager.create(count, out);
+		(void)std::initializer_list<int>{ (insert_copies(storage<Component>(), out, first, prototypes), 0)... };
+	}
+
+	// Observer hooks of the container of 'Component', see ComponentContainer::on_construct
+	template <typename Component>
+	Signal& on_construct() { return storage<Component>().on_construct(); }
+	template <typename Component>
+	Signal& on_destroy() { return storage<Component>().on_destroy(); }
+	template <typename Component>
+	Signal& on_update() { return storage<Component>().on_update(); }
+
+	// The mask with the bits of all given component types set
+	template <typename... Component>
+	static ComponentMask mask_of()
+	{
+		ComponentMask mask;
+		(void)std::initializer_list<int>{ (mask.set(component_id<Component>()), 0)... };
+		return mask;
+	}
+
+	// The mask of all component types the entity has, empty for released entities
+	ComponentMask signature(Entity e) const
+	{
+		if (!entity_manager.alive(e) || e.index() >= signatures.size())
+			return ComponentMask();
+		return signatures[e.index()];
+	}
+
+	// A single mask test whether the entity has all 'Component's and none of the excluded ones,
+	// e.g. registry.matches<Minion>(e, exclude<Player>)
+	template <typename... Component, typename... Excluded>
+	bool matches(Entity e, Exclude<Excluded...> = {}) const
+	{
+		const ComponentMask mask = signature(e);
+		const ComponentMask include = mask_of<Component...>();
+		return (mask & include) == include && (mask & mask_of<Excluded...>()).none();
+	}
+
+	// Iterate all entities that have every 'Component' and none of the excluded ones, e.g.
+	// registry.view<Motion, RenderRequest>().each([](Entity e, MotionRef m, RenderRequest& r) { ... });
+	// registry.view<Motion>(exclude<Player>)
+	template <typename... Component, typename... Excluded>
+	View<std::tuple<Component...>, std::tuple<Excluded...>> view(Exclude<Excluded...> = {})
+	{
+		return View<std::tuple<Component...>, std::tuple<Excluded...>>(storage<Component>()..., storage<Excluded>()...);
+	}
+
+	// Same as view() but the matching entities are cached across frames. The first call collects
+	// them, after that they are patched by the construct/destroy signals of the involved containers.
+	// Use it for the queries that run every frame.
+	// registry.query<Motion>(exclude<Player>).each([](Entity e, MotionRef m) { ... });
+	template <typename... Component, typename... Excluded>
+	Query<Component...> query(Exclude<Excluded...> = {})
+	{
+		static_assert(sizeof...(Component) > 0, "A query needs at least one component type");
+		const ComponentMask include = mask_of<Component...>();
+		const ComponentMask exclude = mask_of<Excluded...>();
+		for (auto& cache : queries)
+			if (cache->include == include && cache->exclude == exclude)
+				return Query<Component...>(cache.get(), storage<Component>()...);
+
+		QueryCache* cache = new QueryCache(&signatures, include, exclude);
+		queries.emplace_back(cache);
+		(void)std::initializer_list<int>{ (storage<Component>().on_construct().connect(&QueryCache::on_construct, cache),
+			storage<Component>().on_destroy().connect(&QueryCache::on_destroy<component_id<Component>()>, cache), 0)... };
+		(void)std::initializer_list<int>{ (storage<Excluded>().on_construct().connect(&QueryCache::on_construct, cache),
+			storage<Excluded>().on_destroy().connect(&QueryCache::on_destroy<component_id<Excluded>()>, cache), 0)... };
+
+		// Every match has the first component, its entities are the candidates
+		const std::array<const std::vector<Entity>*, sizeof...(Component)> candidates = { &storage<Component>().entities... };
+		for (Entity e : *candidates[0])
+			cache->update(e, signatures[e.index()]);
+		return Query<Component...>(cache, storage<Component>()...);
+	}
+
+	void clear_all_components() {
+		for_each_container([](auto& container) { container.clear(); });
+	}
+
+	void list_all_components() {
+		printf("Debug info on all registry entries:\n");
+		for_each_container([](auto& container) {
+			if (container.size() > 0)
+				printf("%4d components of type %s\n", (int)container.size(), typeid(container).name());
+		});
+	}
+
+	// Where the memory of the containers and their lookup tables goes, see MemoryReport::print()
+	MemoryReport memory_report() {
+		MemoryReport report;
+		for_each_container([&](auto& container) { report.containers.push_back(container.memory_usage()); });
+		report.live_entities = entity_manager.size();
+		report.entity_capacity = entity_manager.capacity();
+		report.entity_bytes = entity_manager.memory_bytes();
+		report.signature_bytes = signatures.capacity() * sizeof(ComponentMask);
+		for (auto& cache : queries)
+			report.query_bytes += sizeof(QueryCache) + cache->memory_bytes();
+		return report;
+	}
+
+	void list_all_components_of(Entity e) {
+		printf("Debug info on components of entity %u:\n", (unsigned int)e);
+		for_each_container([e](auto& container) {
+			if (container.has(e))
+				printf("type %s\n", typeid(container).name());
+		});
+	}
+
+	// Removes the component with the given id from an entity
+	void remove_component(size_t id, Entity e) {
+		removers[id](*this, e);
+	}
+
+	// Destroys the entity, its index is re-used by the next entities created.
+	// Only the containers set in the entity signature are touched.
+	void remove_all_components_of(Entity e) {
+		const ComponentMask mask = signature(e);
+		for (size_t id = 0; id < component_count; id++)
+			if (mask.test(id))
+				removers[id](*this, e);
+		entity_manager.release(e);
+	}
+
+	// Start a new frame for the change tracking, call once per game loop iteration
+	void advance_frame() {
+		current_frame++;
+	}
+
+	// Copy the entity ids and all containers of trivially copyable components into one buffer.
+	// Component pointers (e.g. Mesh*) are copied as they are, so a snapshot is only valid in this process.
+	Snapshot snapshot()
+	{
+		SnapshotWriter out;
+		entity_manager.save(out);
+		for_each_container([&](auto& container) { container.save(out); });
+		return std::move(out.buffer);
+	}
+
+	// Reset the registry to the state of a snapshot with one bulk copy per container, then rebuild
+	// the sparse indices, signatures and query caches. No signals are published. Owning groups are
+	// not known to the registry and have to be rebuilt by the caller, see ECSRegistry::restore().
+	void restore(const Snapshot& snapshot)
+	{
+		assert(commands.empty() && "Flush or drop the pending commands before restoring a snapshot");
+		SnapshotReader in(snapshot);
+		entity_manager.load(in);
+		std::fill(signatures.begin(), signatures.end(), ComponentMask());
+		for_each_container([&](auto& container) { container.load(in); });
+
+		for (auto& cache : queries)
+			cache->clear();
+		for_each_container([&](auto& container) {
+			for (Entity e : container.entities)
+				for (auto& cache : queries)
+					cache->update(e, signatures[e.index()]);
+		});
+	}
+
+	// Sync point, applies all changes recorded in 'commands'
+	void flush_commands() {
+		commands.flush(*this);
 	}
 };
+template <typename... Components>
+constexpr size_t Registry<Components...>::component_count;
@@ -3,69 +3,73 @@
 
 #include "tiny_ecs.hpp"
 #include "components.hpp"
+#include "contact_buffer.hpp"
+#include "motion_soa.hpp"
 
-class ECSRegistry
-{
-	// Callbacks to remove a particular or all entities in the system
-	std::vector<ContainerInterface*> registry_list;
+// The renderer keeps a pointer to the LightSource of the directional light, paged storage keeps
+// it valid when further lights are added
+template <>
+struct component_array<LightSource> { typedef PagedVector<LightSource> type; };
+
+// Motion is stored as structure of arrays, the physics step streams over its position, velocity
+// and scale arrays. get() and the views hand out MotionRef proxies instead of Motion&.
+template <>
+struct component_array<Motion> { typedef MotionSoA type; };
+
+// All components this game has, each one gets a container in the registry
+using ComponentRegistry = Registry<
+	DeathTimer,
+	Motion,
+	Collider,
+	Player,
+	Mesh*,
+	RenderRequest,
+	ScreenState,
+	Minion,
+	Eatable,
+	DebugComponent,
+	vec3,
+	Background,
+	LightSource>;
 
+class ECSRegistry : public ComponentRegistry
+{
 public:
-	// Manually created list of all components this game has
+	// Named access to the containers of the component type list above
 	// TODO: A1 add a LightUp component
-	ComponentContainer<DeathTimer> deathTimers;
-	ComponentContainer<Motion> motions;
-	ComponentContainer<Collision> collisions;
-	ComponentContainer<Player> players;
-	ComponentContainer<Mesh*> meshPtrs;
-	ComponentContainer<RenderRequest> renderRequests;
-	ComponentContainer<ScreenState> screenStates;
-	ComponentContainer<Minion> minions;
-	ComponentContainer<Eatable> eatables;
-	ComponentContainer<DebugComponent> debugComponents;
-	ComponentContainer<vec3> colors;
-	ComponentContainer<Background> backgrounds;
-	ComponentContainer<LightSource> lightSources;
-  
-	// constructor that adds all containers for looping over them
-	// IMPORTANT: Don't forget to add any newly added containers!
-	ECSRegistry()
-	{
-		registry_list.push_back(&deathTimers);
-		registry_list.push_back(&motions);
-		registry_list.push_back(&collisions);
-		registry_list.push_back(&players);
-		registry_list.push_back(&meshPtrs);
-		registry_list.push_back(&renderRequests);
-		registry_list.push_back(&screenStates);
-		registry_list.push_back(&minions);
-		registry_list.push_back(&debugComponents);
-		registry_list.push_back(&colors);
-		registry_list.push_back(&backgrounds);
-		registry_list.push_back(&lightSources);
-	}
+	ComponentContainer<DeathTimer>& deathTimers = storage<DeathTimer>();
+	ComponentContainer<Motion>& motions = storage<Motion>();
+	ComponentContainer<Collider>& colliders = storage<Collider>();
+	ComponentContainer<Player>& players = storage<Player>();
+	ComponentContainer<Mesh*>& meshPtrs = storage<Mesh*>();
+	ComponentContainer<RenderRequest>& renderRequests = storage<RenderRequest>();
+	ComponentContainer<ScreenState>& screenStates = storage<ScreenState>();
+	TagContainer<Minion>& minions = storage<Minion>();
+	ComponentContainer<Eatable>& eatables = storage<Eatable>();
+	TagContainer<DebugComponent>& debugComponents = storage<DebugComponent>();
+	ComponentContainer<vec3>& colors = storage<vec3>();
+	TagContainer<Background>& backgrounds = storage<Background>();
+	ComponentContainer<LightSource>& lightSources = storage<LightSource>();
 
-	void clear_all_components() {
-		for (ContainerInterface* reg : registry_list)
-			reg->clear();
-	}
+	// Everything that is drawn, with Motion, RenderRequest and Mesh* kept in the same order
+	Group<Motion, RenderRequest, Mesh*> render_group{ motions, renderRequests, meshPtrs };
 
-	void list_all_components() {
-		printf("Debug info on all registry entries:\n");
-		for (ContainerInterface* reg : registry_list)
-			if (reg->size() > 0)
-				printf("%4d components of type %s\n", (int)reg->size(), typeid(*reg).name());
-	}
+	// The contacts of the last physics step, filled by PhysicsSystem::step and consumed by
+	// WorldSystem::handle_collisions
+	ContactBuffer contacts;
 
-	void list_all_components_of(Entity e) {
-		printf("Debug info on components of entity %u:\n", (unsigned int)e);
-		for (ContainerInterface* reg : registry_list)
-			if (reg->has(e))
-				printf("type %s\n", typeid(*reg).name());
+	// Calls func(Entity with A, Entity with B) for the contacts between entities with A and B
+	template <typename A, typename B, typename Func>
+	void each_contact(Func func)
+	{
+		contacts.each<A, B>(*this, func);
 	}
 
-	void remove_all_components_of(Entity e) {
-		for (ContainerInterface* reg : registry_list)
-			reg->remove(e);
+	// Registry::restore() plus the groups defined here
+	void restore(const Snapshot& snapshot)
+	{
+		ComponentRegistry::restore(snapshot);
+		render_group.rebuild();
 	}
 };
 
@@ -8,12 +8,13 @@ Entity createBullet(RenderSystem* renderer, vec2 pos, vec2 velocity) {
 	// Mesh& mesh = renderer->getMesh(GEOMETRY_BUFFER_ID::SPRITE);
 	// registry.meshPtrs.emplace(entity, &mesh);
 	std::cout << "Left button pressed" << std::endl;  // Debug message
-	Motion& motion = registry.motions.emplace(entity);
+	MotionRef motion = registry.motions.emplace(entity);
 	motion.position = pos;
 	motion.angle = 0.f;
 	motion.velocity = velocity;
 	// Vicky M1: scale could change after render decided 
 	motion.scale = vec2(1.0f, 1.0f);
+	registry.colliders.insert(entity, { ColliderShape::CIRCLE });
 
 	// Create and (empty) Eagle component to be able to refer to all eagles
 	// TODO
@@ -36,7 +37,7 @@ Entity create_background(RenderSystem* renderer, vec2 position, vec2 bounds)
 	registry.meshPtrs.emplace(entity, &mesh);
 
 	// Initialize the motion
-	auto& motion = registry.motions.emplace(entity);
+	auto motion = registry.motions.emplace(entity);
 	motion.angle = 0.f;
 
 	motion.velocity = { 0.f, 0.f };
@@ -69,7 +70,7 @@ Entity create_blendy(RenderSystem* renderer, vec2 position, vec2 bounds)
 	registry.meshPtrs.emplace(entity, &mesh);
 
 	// Initialize the motion
-	auto& motion = registry.motions.emplace(entity);
+	auto motion = registry.motions.emplace(entity);
 	motion.angle = 0.f;
 	motion.velocity = { 0.f, 0.f };
 	motion.position = position;
@@ -78,6 +79,11 @@ Entity create_blendy(RenderSystem* renderer, vec2 position, vec2 bounds)
 	// Setting initial values, scale is negative to make it face the opposite way
 	motion.scale = vec2({ -bounds.x, bounds.y });
 
+	// Collide with the hull of the mesh
+	Collider& collider = registry.colliders.emplace(entity);
+	collider.shape = ColliderShape::POLYGON;
+	collider.mesh = &mesh;
+
 	// Create an (empty) Blendy component to be able to refer to Blendy
 	registry.players.emplace(entity);
 	registry.renderRequests.insert(
@@ -99,7 +105,7 @@ Entity create_directional_light(RenderSystem* renderer, vec2 position, vec2 boun
 	registry.meshPtrs.emplace(entity, &mesh);
 
 	// Initialize the motion
-	auto& motion = registry.motions.emplace(entity);
+	auto motion = registry.motions.emplace(entity);
 	motion.angle = 0.f;
 	motion.velocity = { 0.f, 0.f };
 	motion.position = position;
@@ -126,33 +132,25 @@ Entity create_directional_light(RenderSystem* renderer, vec2 position, vec2 boun
 	return entity;
 }
 
-Entity create_minion(RenderSystem* renderer, vec2 position, vec2 bounds)
+void create_minions(RenderSystem* renderer, const std::vector<vec2>& positions, vec2 bounds)
 {
-	auto entity = Entity();
-
-	// Store a reference to the potentially re-used mesh object (the value is stored in the resource cache)
 	Mesh& mesh = renderer->getMesh(GEOMETRY_BUFFER_ID::SPRITE);
-	registry.meshPtrs.emplace(entity, &mesh);
 
-	// Initialize the motion
-	auto& motion = registry.motions.emplace(entity);
+	// All minions start alike, only the position differs
+	Motion motion;
 	motion.angle = 0.f;
 	motion.velocity = { 0, 100.f };
-	motion.position = position;
-
-	// Setting initial values, scale is negative to make it face the opposite way
 	motion.scale = vec2({ -bounds.x, bounds.y });
 
-	// Create and (empty) Minion component to be able to refer to all minions
-	registry.minions.emplace(entity);
-	registry.renderRequests.insert(
-		entity,
-		{ TEXTURE_ASSET_ID::MINION,
-			TEXTURE_ASSET_ID::MINION_NM,
-		 EFFECT_ASSET_ID::TEXTURED,
-		 GEOMETRY_BUFFER_ID::SPRITE });
+	std::vector<Entity> minions;
+	registry.spawn(positions.size(), minions, &mesh, motion, Collider(), Minion(), RenderRequest{
+		TEXTURE_ASSET_ID::MINION,
+		TEXTURE_ASSET_ID::MINION_NM,
+		EFFECT_ASSET_ID::TEXTURED,
+		GEOMETRY_BUFFER_ID::SPRITE });
 
-	return entity;
+	for (size_t i = 0; i < minions.size(); i++)
+		registry.motions.get(minions[i]).position = positions[i];
 }
 
 Entity create_powerup(RenderSystem* renderer, vec2 position, vec2 bounds) {
@@ -163,7 +161,8 @@ Entity create_powerup(RenderSystem* renderer, vec2 position, vec2 bounds) {
 	registry.meshPtrs.emplace(entity, &mesh);
 
 	// Initialize the motion
-	auto& motion = registry.motions.emplace(entity);
+	auto motion = registry.motions.emplace(entity);
+	registry.colliders.emplace(entity);
 	registry.eatables.emplace(entity);
 	motion.angle = 0.f;
 	motion.velocity = { 0, 0 };
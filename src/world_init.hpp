@@ -27,8 +27,8 @@ Entity create_blendy(RenderSystem* renderer, vec2 pos, vec2 bounds);
 // the directional light for Blinn-Phong
 Entity create_directional_light(RenderSystem* renderer, vec2 pos, vec2 bounds);
 
-// the minions
-Entity create_minion(RenderSystem* renderer, vec2 position, vec2 bounds);
+// the minions, one at each position, created in a single batch
+void create_minions(RenderSystem* renderer, const std::vector<vec2>& positions, vec2 bounds);
 
 Entity create_powerup(RenderSystem* renderer, vec2 position, vec2 bounds);
 
@@ -131,8 +131,9 @@ GLFWwindow* WorldSystem::create_window() {
 	return window;
 }
 
-void WorldSystem::init(RenderSystem* renderer_arg) {
+void WorldSystem::init(RenderSystem* renderer_arg, PhysicsSystem* physics_arg) {
 	this->renderer = renderer_arg;
+	this->physics = physics_arg;
 	// Playing background music indefinitely
 	Mix_PlayMusic(background_music, -1);
 	fprintf(stderr, "Loaded music\n");
@@ -145,11 +146,18 @@ void WorldSystem::update_minions(float elapsed_ms_since_last_update)
 {
 	next_minion_spawn -= elapsed_ms_since_last_update * current_speed;
 
-	if (registry.minions.components.size() <= MAX_MINIONS && next_minion_spawn < 0.f) {
-		next_minion_spawn = (MINION_DELAY_MS / 2) + uniform_dist(rng) * (MINION_DELAY_MS / 2);
+	// Don't let spawns pile up while at the cap (or over a restart), at most about two are due at once
+	next_minion_spawn = std::max(next_minion_spawn, -(float)MINION_DELAY_MS);
 
-		create_minion(renderer, vec2(50.f + uniform_dist(rng) * (window_width_px - 100.f), 0.0f), MINION_BOUNDS);
+	// All spawns that fell into this step (several after a long frame) are created as one batch
+	std::vector<vec2> positions;
+	while (registry.minions.size() + positions.size() <= MAX_MINIONS && next_minion_spawn < 0.f) {
+		next_minion_spawn += (MINION_DELAY_MS / 2) + uniform_dist(rng) * (MINION_DELAY_MS / 2);
+
+		positions.push_back(vec2(50.f + uniform_dist(rng) * (window_width_px - 100.f), 0.0f));
 	}
+	if (!positions.empty())
+		create_minions(renderer, positions, MINION_BOUNDS);
 }
 
 // Update our game world
@@ -160,20 +168,14 @@ bool WorldSystem::step(float elapsed_ms_since_last_update) {
 	while (registry.debugComponents.entities.size() > 0)
 	    registry.remove_all_components_of(registry.debugComponents.entities.back());
 
-	// Removing out of screen entities
-	auto& motions_registry = registry.motions;
-
-	//Main LOOP
-	for (int i = (int)motions_registry.components.size()-1; i>=0; --i) {
-	    Motion& motion = motions_registry.components[i];
-		if (motion.position.x + abs(motion.scale.x) < 0.f) {
-			if(!registry.players.has(motions_registry.entities[i])) 
-				registry.remove_all_components_of(motions_registry.entities[i]);
-		}
-	}
+	// Removing out of screen entities, deferred until the loop is done
+	registry.query<Motion>(exclude<Player>).each([](Entity entity, MotionRef motion) {
+		if (motion.position.x + abs(motion.scale.x) < 0.f)
+			registry.commands.destroy(entity);
+	});
 
 	if (is_dead) {
-		Motion& player_motion = registry.motions.get(player_blendy);
+		MotionRef player_motion = registry.motions.patch(player_blendy);
 		float sec_passed = elapsed_ms_since_last_update / 1000;
 		player_motion.velocity = player_motion.velocity*(1 - sec_passed) + dead_velocity * sec_passed;
 		player_motion.angle = player_motion.angle * (1 - sec_passed) + dead_angle * sec_passed;
@@ -187,6 +189,7 @@ bool WorldSystem::step(float elapsed_ms_since_last_update) {
     ScreenState &screen = registry.screenStates.components[0];
 
     float min_counter_ms = 3000.f;
+	bool restart = false;
 	for (Entity entity : registry.deathTimers.entities) {
 		// progress timer
 		DeathTimer& counter = registry.deathTimers.get(entity);
@@ -199,12 +202,15 @@ bool WorldSystem::step(float elapsed_ms_since_last_update) {
 
 		// restart the game once the death timer expired
 		if (counter.counter_ms < 0) {
-			registry.deathTimers.remove(entity);
-			screen.darken_screen_factor = 0;
-            restart_game();
-			return true;
+			registry.commands.remove<DeathTimer>(entity);
+			restart = true;
 		}
 	}
+	if (restart) {
+		screen.darken_screen_factor = 0;
+		restart_game();
+		return true;
+	}
 	// reduce window brightness if any of the present chickens is dying
 	screen.darken_screen_factor = 1 - min_counter_ms / 3000;
 
@@ -220,6 +226,19 @@ void WorldSystem::restart_game() {
 	// Reset the game speed
 	current_speed = 1.f;
 
+	// Apply pending changes first so that none of them refers to the old world
+	registry.flush_commands();
+
+	is_dead = false;
+
+	// Later restarts copy the initial state back, which also brings back the ids of the entities below
+	if (!initial_state.empty())
+	{
+		registry.restore(initial_state);
+		renderer->setDirectionalLight(directional_light); // its LightSource was copied back
+		return;
+	}
+
 	// Remove all entities that we created
 	// All that have a motion, we could also iterate over all bug, eagles, ... but that would be more cumbersome
 	while (registry.motions.entities.size() > 0)
@@ -228,16 +247,16 @@ void WorldSystem::restart_game() {
 	// Debugging for memory/component leaks
 	registry.list_all_components();
 
-	is_dead = false;
 	game_background = create_background(renderer, CENTER_OF_SCREEN, BACKGROUND_BOUNDS);
 	player_blendy = create_blendy(renderer, BLENDY_START_POSITION, BLENDY_BOUNDS);
 	directional_light = create_directional_light(renderer, BOTTOM_RIGHT_OF_SCREEN_DIRECTIONAL_LIGHT, DIRECTIONAL_LIGHT_BOUNDS);
+	initial_state = registry.snapshot();
 }
 
 void WorldSystem::dead_player() {
 	is_dead = true;
 	auto& motions_registry = registry.motions;
-	Motion& motion = motions_registry.get(player_blendy);
+	MotionRef motion = motions_registry.patch(player_blendy);
 	motion.velocity.x = 0;
 	motion.velocity.y = 0;
 	motion.angle = { 0.0f };
@@ -247,33 +266,20 @@ void WorldSystem::dead_player() {
 
 // Compute collisions between entities
 void WorldSystem::handle_collisions() {
-	// Loop over all collisions detected by the physics system
-	auto& collisionsRegistry = registry.collisions;
-	for (uint i = 0; i < collisionsRegistry.components.size(); i++) {
-		// The entity and its collider
-		Entity entity = collisionsRegistry.entities[i];
-		Entity entity_other = collisionsRegistry.components[i].other;
-
-		// Only interested in collisions that involve Blendy
-		if (registry.players.has(entity)) {
-			//Player& player = registry.players.get(entity);
-
-			// Checking Player - Minion collisions
-			if (registry.minions.has(entity_other)) {
-				// initiate death unless already dying
-				if (!registry.deathTimers.has(entity)) {
-					// Kill blendy and reset death timer
-					registry.deathTimers.emplace(entity);
-					// add some sound effect
-					// switch to dead animation
-					Mix_PlayChannel(-1, dead_sound, 0);
-					dead_player();
-				}
-			}
+	// Checking Player - Minion collisions detected by the physics system
+	registry.each_contact<Player, Minion>([&](Entity entity, Entity) {
+		// initiate death unless already dying
+		if (!registry.deathTimers.has(entity)) {
+			// Kill blendy and reset death timer
+			registry.deathTimers.emplace(entity);
+			// add some sound effect
+			// switch to dead animation
+			Mix_PlayChannel(-1, dead_sound, 0);
+			dead_player();
 		}
-	}
-	// Remove all collisions from this simulation step
-	registry.collisions.clear();
+	});
+	// Remove all collisions from this simulation step, the buffer keeps its memory
+	registry.contacts.clear();
 }
 
 // Should the game be over ?
@@ -283,7 +289,7 @@ bool WorldSystem::is_over() const {
 
 void WorldSystem::move_player(vec2 direction) {
 	auto& motions_registry = registry.motions;
-	Motion& player_motion = motions_registry.get(player_blendy);
+	MotionRef player_motion = motions_registry.patch(player_blendy);
 	float& speed = registry.players.get(player_blendy).max_speed;
 	player_motion.velocity.x = direction.x * speed;
 	player_motion.velocity.y = direction.y * speed;
@@ -325,30 +331,35 @@ void WorldSystem::handlePlayerMovement(int key, int action) {
 void WorldSystem::on_key(int key, int, int action, int mod) {
 	handlePlayerMovement(key, action);
 
-	auto& motion = registry.motions.get(directional_light);
-	vec2& new_pos = motion.position;
+	// Move the light with I/J/K/L, only then its motion counts as changed
+	vec2 light_offset = { 0.f, 0.f };
 	if ((action == GLFW_PRESS || action == GLFW_REPEAT) && key == GLFW_KEY_I) {
-		  new_pos = { motion.position.x, motion.position.y - LIGHT_SOURCE_MOVEMENT_DISTANCE };
+		light_offset = { 0.f, -LIGHT_SOURCE_MOVEMENT_DISTANCE };
 	}
 
 	if ((action == GLFW_PRESS || action == GLFW_REPEAT) && key == GLFW_KEY_J) {
-		new_pos = { motion.position.x - LIGHT_SOURCE_MOVEMENT_DISTANCE, motion.position.y };
+		light_offset = { -LIGHT_SOURCE_MOVEMENT_DISTANCE, 0.f };
 	}
 
 	if ((action == GLFW_PRESS || action == GLFW_REPEAT) && key == GLFW_KEY_K) {
-		new_pos = { motion.position.x, motion.position.y + LIGHT_SOURCE_MOVEMENT_DISTANCE };
+		light_offset = { 0.f, LIGHT_SOURCE_MOVEMENT_DISTANCE };
 	}
 
 	if ((action == GLFW_PRESS || action == GLFW_REPEAT) && key == GLFW_KEY_L) {
-		new_pos = { motion.position.x + LIGHT_SOURCE_MOVEMENT_DISTANCE, motion.position.y };
+		light_offset = { LIGHT_SOURCE_MOVEMENT_DISTANCE, 0.f };
 	}
 
-	// check window boundary
-	if (new_pos.x < 0) new_pos.x = DIRECTIONAL_LIGHT_BB_WIDTH / 2;
-	if (new_pos.y < 0) new_pos.y = DIRECTIONAL_LIGHT_BB_HEIGHT / 2;
-	if (new_pos.x > window_width_px) new_pos.x = window_width_px - DIRECTIONAL_LIGHT_BB_WIDTH / 2;
-	if (new_pos.y > window_height_px) new_pos.y = window_height_px - DIRECTIONAL_LIGHT_BB_HEIGHT / 2;
-	motion.position = new_pos;
+	if (light_offset.x != 0.f || light_offset.y != 0.f) {
+		auto motion = registry.motions.patch(directional_light);
+		vec2 new_pos = motion.position + light_offset;
+
+		// check window boundary
+		if (new_pos.x < 0) new_pos.x = DIRECTIONAL_LIGHT_BB_WIDTH / 2;
+		if (new_pos.y < 0) new_pos.y = DIRECTIONAL_LIGHT_BB_HEIGHT / 2;
+		if (new_pos.x > window_width_px) new_pos.x = window_width_px - DIRECTIONAL_LIGHT_BB_WIDTH / 2;
+		if (new_pos.y > window_height_px) new_pos.y = window_height_px - DIRECTIONAL_LIGHT_BB_HEIGHT / 2;
+		motion.position = new_pos;
+	}
 
 	// Resetting game
 	if (action == GLFW_RELEASE && key == GLFW_KEY_R) {
@@ -358,6 +369,18 @@ void WorldSystem::on_key(int key, int, int action, int mod) {
         restart_game();
 	}
 
+	// Cycle through the collision broadphases
+	if (action == GLFW_RELEASE && key == GLFW_KEY_B) {
+		const int next = ((int)physics->get_broadphase() + 1) % (int)BroadphaseMode::MODE_COUNT;
+		physics->set_broadphase((BroadphaseMode)next);
+		printf("Broadphase = %s\n", broadphase_name(physics->get_broadphase()));
+	}
+
+	// Memory report of the ECS containers
+	if (action == GLFW_RELEASE && key == GLFW_KEY_M) {
+		registry.memory_report().print();
+	}
+
 	// Debugging
 	if (key == GLFW_KEY_D) {
 		if (action == GLFW_RELEASE)
@@ -381,7 +404,7 @@ void WorldSystem::on_key(int key, int, int action, int mod) {
 void WorldSystem::on_mouse_move(vec2 mouse_position) {
 
 	float timer = 0.0f;
-	Motion& motion = registry.motions.get(player_blendy);
+	MotionRef motion = registry.motions.get(player_blendy);
 	vec2& blendy_pos = motion.position;
 
 	if (!is_dead) {
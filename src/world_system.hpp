@@ -12,6 +12,7 @@
 #include <SDL_mixer.h>
 
 #include "render_system.hpp"
+#include "physics_system.hpp"
 
 // Container for all our entities and game logic. Individual rendering / update is
 // deferred to the relative update() methods
@@ -24,7 +25,7 @@ public:
 	GLFWwindow* create_window();
 
 	// starts the game
-	void init(RenderSystem* renderer);
+	void init(RenderSystem* renderer, PhysicsSystem* physics);
 
 	// Releases all associated resources
 	~WorldSystem();
@@ -61,12 +62,16 @@ private:
 
 	// Game state
 	RenderSystem* renderer;
+	PhysicsSystem* physics;
 	float current_speed;
 	Entity player_blendy;
 	Entity game_background;
 	Entity directional_light;
 	float next_minion_spawn;
 
+	// The registry right after the first start, later restarts restore it
+	Snapshot initial_state;
+
 	// music references
 	Mix_Music* background_music;
 	Mix_Chunk* dead_sound;